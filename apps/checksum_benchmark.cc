@@ -0,0 +1,92 @@
+#include "util.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+using Kernel = InternetChecksum::Kernel;
+
+constexpr size_t total_bytes = 1024 * 1024 * 1024;
+
+//! Checksum `size`-byte spans (a TCP header, a small segment, an Ethernet-MTU segment, a 64 KiB super-segment)
+//! until `total_bytes` have been summed, and report the rate.
+void main_loop(const string &name, const Kernel kernel, const size_t size) {
+    string data(size, 0);
+    auto rd = get_random_generator();
+    for (auto &c : data) {
+        c = char(rd());
+    }
+
+    const size_t iterations = total_bytes / size;
+    const auto first_time = high_resolution_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        InternetChecksum check{0, kernel};
+        check.add(data);
+        check.value();
+    }
+    const auto final_time = high_resolution_clock::now();
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+
+    cout << fixed << setprecision(2);
+    cout << left << setw(8) << name << right << setw(7) << size << " bytes: " << setw(7)
+         << double(iterations * size) / double(duration) << " GB/s (" << setw(6)
+         << double(duration) / double(iterations) << " ns per call)\n";
+}
+
+//! Copy and checksum `size`-byte spans, in two passes (memcpy, then add) or in one (add_copy)
+void copy_loop(const bool fused, const size_t size) {
+    const string data(size, 'x');
+    string copy(size, 0);
+
+    const size_t iterations = total_bytes / size;
+    const auto first_time = high_resolution_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        InternetChecksum check;
+        if (fused) {
+            check.add_copy(copy.data(), data);
+        } else {
+            memcpy(copy.data(), data.data(), size);
+            check.add(copy);
+        }
+        check.value();
+    }
+    const auto final_time = high_resolution_clock::now();
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+
+    cout << fixed << setprecision(2);
+    cout << left << setw(15) << (fused ? "add_copy" : "memcpy + add") << right << setw(7) << size << " bytes: "
+         << setw(7) << double(iterations * size) / double(duration) << " GB/s\n";
+}
+
+int main() {
+    try {
+        const vector<pair<Kernel, string>> kernels = {
+            {Kernel::Scalar, "scalar"}, {Kernel::Word64, "word64"}, {Kernel::SSE2, "SSE2"}, {Kernel::AVX2, "AVX2"}};
+        for (const auto &[kernel, name] : kernels) {
+            if (not InternetChecksum::supported(kernel)) {
+                cout << name << ": not supported by this CPU\n";
+                continue;
+            }
+            for (const size_t size : {20, 64, 1500, 65536}) {
+                main_loop(name, kernel, size);
+            }
+        }
+        for (const size_t size : {1500, 65536, 1048576}) {
+            copy_loop(false, size);
+            copy_loop(true, size);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
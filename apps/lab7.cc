@@ -106,10 +106,23 @@ class NetworkInterfaceAdapter : public TCPOverIPv4Adapter {
 
         return {};
     }
+    vector<TCPSegment> read_many() {
+        vector<TCPSegment> ret;
+        if (auto seg = read()) {
+            ret.push_back(move(seg.value()));
+        }
+        return ret;
+    }
     void write(TCPSegment &seg) {
         _interface.send_datagram(wrap_tcp_in_ip(seg), _next_hop);
         send_pending();
     }
+    void write_many(queue<TCPSegment> &segments) {
+        while (not segments.empty()) {
+            write(segments.front());
+            segments.pop();
+        }
+    }
     void tick(const size_t ms_since_last_tick) {
         _interface.tick(ms_since_last_tick);
         send_pending();
@@ -0,0 +1,93 @@
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t len = 64 * 1024 * 1024;
+constexpr size_t capacity = 64000;
+constexpr size_t seg_len = 1000;
+
+enum class Pattern { InOrder, Reversed, Overlapping };
+
+//! Cut one window's worth of the stream into (offset, length) pieces in the given pattern
+vector<tuple<size_t, size_t>> make_pieces(const Pattern pattern, mt19937 &rd) {
+    vector<tuple<size_t, size_t>> pieces;
+    for (size_t off = 0; off < capacity; off += seg_len) {
+        pieces.emplace_back(off, min(seg_len, capacity - off));
+    }
+    if (pattern == Pattern::Reversed) {
+        reverse(pieces.begin(), pieces.end());
+    } else if (pattern == Pattern::Overlapping) {
+        // every piece is pushed again, extended halfway into its neighbour, in a random order
+        const size_t n = pieces.size();
+        for (size_t i = 0; i < n; ++i) {
+            const auto [off, sz] = pieces[i];
+            pieces.emplace_back(off, min(sz + seg_len / 2, capacity - off));
+        }
+        shuffle(pieces.begin(), pieces.end(), rd);
+    }
+    return pieces;
+}
+
+void run(const StreamReassembler::Mode mode, const Pattern pattern) {
+    auto rd = get_random_generator();
+    string data(len, 0);
+    generate(data.begin(), data.end(), [&] { return rd(); });
+    const auto pieces = make_pieces(pattern, rd);
+
+    StreamReassembler reassembler{capacity, ByteStream::Storage::Ring, mode};
+    string received;
+    received.reserve(len);
+
+    const auto first_time = high_resolution_clock::now();
+
+    for (size_t base = 0; base < len; base += capacity) {
+        for (const auto &[off, sz] : pieces) {
+            const size_t index = base + off;
+            if (index >= len) {
+                continue;
+            }
+            const size_t size = min(sz, len - index);
+            reassembler.push_substring(data.substr(index, size), index, index + size == len);
+        }
+        received.append(reassembler.stream_out().read(reassembler.stream_out().buffer_size()));
+    }
+
+    const auto final_time = high_resolution_clock::now();
+
+    if (received != data) {
+        throw runtime_error("reassembled bytes don't match");
+    }
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+    const auto gigabits_per_second = len * 8.0 / double(duration);
+
+    cout << fixed << setprecision(2);
+    cout << (mode == StreamReassembler::Mode::Map ? "Map   " : "Window") << " reassembler, "
+         << (pattern == Pattern::InOrder ? "in order   " : pattern == Pattern::Reversed ? "reversed   " : "overlapping")
+         << ": " << gigabits_per_second << " Gbit/s\n";
+}
+
+int main() {
+    try {
+        for (const auto pattern : {Pattern::InOrder, Pattern::Reversed, Pattern::Overlapping}) {
+            run(StreamReassembler::Mode::Map, pattern);
+            run(StreamReassembler::Mode::Window, pattern);
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -28,9 +28,11 @@ void move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segme
     segments.clear();
 }
 
-void main_loop(const bool reorder) {
+void main_loop(const bool reorder, const ByteStream::Storage recv_storage) {
     TCPConfig config;
+    config.recv_storage = recv_storage;
     TCPConnection x{config}, y{config};
+    const bool chunks = recv_storage == ByteStream::Storage::Chunks;
 
     string string_to_send(len, 'x');
     for (auto &ch : string_to_send) {
@@ -71,7 +73,12 @@ void main_loop(const bool reorder) {
 
         // read output from y
         const auto available_output = y.inbound_stream().buffer_size();
-        if (available_output > 0) {
+        if (available_output > 0 and chunks) {
+            const BufferList received = y.inbound_stream().read_buffers(available_output);
+            for (const auto &buf : received.buffers()) {
+                string_received.append(buf);
+            }
+        } else if (available_output > 0) {
             string_received.append(y.inbound_stream().read(available_output));
         }
 
@@ -95,8 +102,8 @@ void main_loop(const bool reorder) {
     const auto gigabits_per_second = len * 8.0 / double(duration);
 
     cout << fixed << setprecision(2);
-    cout << "CPU-limited throughput" << (reorder ? " with reordering: " : "                : ") << gigabits_per_second
-         << " Gbit/s\n";
+    cout << "CPU-limited throughput" << (reorder ? " with reordering" : "                ")
+         << (chunks ? " (chunked recv)" : "               ") << ": " << gigabits_per_second << " Gbit/s\n";
 
     while (x.active() or y.active()) {
         loop();
@@ -105,8 +112,10 @@ void main_loop(const bool reorder) {
 
 int main() {
     try {
-        main_loop(false);
-        main_loop(true);
+        main_loop(false, ByteStream::Storage::Ring);
+        main_loop(true, ByteStream::Storage::Ring);
+        main_loop(false, ByteStream::Storage::Chunks);
+        main_loop(true, ByteStream::Storage::Chunks);
     } catch (const exception &e) {
         cerr << e.what() << "\n";
         return EXIT_FAILURE;
@@ -0,0 +1,86 @@
+#include "tcp_connection.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t write_size = 64;
+constexpr size_t writes_per_ms = 50;
+constexpr size_t len = 64 * 1024 * 1024;
+
+struct Stats {
+    size_t segments = 0;
+    size_t wire_bytes = 0;
+};
+
+//! Serialize (and checksum) every queued segment, as an adapter would, then hand it to the peer
+void move_segments(TCPConnection &x, TCPConnection &y, Stats &stats) {
+    while (not x.segments_out().empty()) {
+        const TCPSegment &seg = x.segments_out().front();
+        stats.wire_bytes += seg.serialize().size();
+        stats.segments++;
+        y.segment_received(seg);
+        x.segments_out().pop();
+    }
+}
+
+//! An application writing `write_size` bytes at a time, `writes_per_ms` times per millisecond;
+//! the network delivers what was sent at the end of each millisecond.
+void main_loop(const string &name, const TCPConfig::Coalescing coalescing, const bool flush_each_ms) {
+    TCPConfig config;
+    config.coalescing = coalescing;
+    TCPConnection x{config}, y{config};
+    const string chunk(write_size, 'x');
+    Stats data, acks;
+
+    x.connect();
+    move_segments(x, y, data);
+    move_segments(y, x, acks);
+    data = acks = {};
+
+    size_t written = 0, received = 0;
+    const auto first_time = high_resolution_clock::now();
+    while (received < len) {
+        for (size_t i = 0; i < writes_per_ms and written < len and x.remaining_outbound_capacity() >= write_size;
+             i++) {
+            written += x.write(chunk);
+        }
+        if (flush_each_ms) {
+            x.flush();
+        }
+        move_segments(x, y, data);
+        move_segments(y, x, acks);
+        received += y.inbound_stream().buffer_size();
+        y.inbound_stream().pop_output(y.inbound_stream().buffer_size());
+        x.tick(1);
+        y.tick(1);
+    }
+    const auto final_time = high_resolution_clock::now();
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+
+    cout << fixed << setprecision(2);
+    cout << left << setw(22) << name << right << setw(9) << data.segments << " data segments (" << setw(7)
+         << double(len) / double(data.segments) << " B each), " << setw(9) << acks.segments << " ACKs, " << setw(6)
+         << 100.0 * double(len) / double(data.wire_bytes + acks.wire_bytes) << "% payload on the wire, "
+         << len * 8.0 / double(duration) << " Gbit/s CPU-limited\n";
+}
+
+int main() {
+    try {
+        cout << len / write_size << " writes of " << write_size << " bytes, " << writes_per_ms << " per ms:\n";
+        main_loop("no coalescing", TCPConfig::Coalescing::None, false);
+        main_loop("Nagle", TCPConfig::Coalescing::Nagle, false);
+        main_loop("cork", TCPConfig::Coalescing::Cork, false);
+        main_loop("cork + flush each ms", TCPConfig::Coalescing::Cork, true);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include "tcp_connection.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+constexpr size_t len = 64 * 1024 * 1024;
+constexpr size_t capacity = 4 * 1024 * 1024;
+constexpr uint64_t one_way_delay_ms = 25;
+constexpr double link_bytes_per_ms = 125000;  // 1 Gbit/s
+
+//! One direction of a link: serializes segments at the link rate, then delays them
+class Link {
+    struct InFlight {
+        double arrival_ms;
+        TCPSegment segment;
+    };
+
+    deque<InFlight> _in_flight{};
+    double _free_at_ms = 0;
+
+  public:
+    void send(TCPConnection &from, const uint64_t now_ms) {
+        while (not from.segments_out().empty()) {
+            TCPSegment &seg = from.segments_out().front();
+            _free_at_ms = max(_free_at_ms, double(now_ms)) +
+                          double(TCPHeader::LENGTH + seg.payload().size()) / link_bytes_per_ms;
+            _in_flight.push_back({_free_at_ms + one_way_delay_ms, move(seg)});
+            from.segments_out().pop();
+        }
+    }
+
+    void deliver(TCPConnection &to, const uint64_t now_ms) {
+        while (not _in_flight.empty() and _in_flight.front().arrival_ms <= double(now_ms)) {
+            to.segment_received(_in_flight.front().segment);
+            _in_flight.pop_front();
+        }
+    }
+};
+
+//! Bulk transfer over a 1 Gbit/s link with a 50 ms RTT, in 1 ms steps of simulated time
+void main_loop(const bool window_scaling) {
+    TCPConfig config;
+    config.recv_capacity = capacity;
+    config.send_capacity = capacity;
+    config.window_scaling = window_scaling;
+    TCPConnection x{config}, y{config};
+    Link forward, backward;
+
+    const string chunk(TCPConfig::DEFAULT_CAPACITY, 'x');
+    size_t bytes_to_send = len;
+    size_t bytes_received = 0;
+    uint64_t now_ms = 0;
+
+    x.connect();
+    while (bytes_received < len) {
+        while (bytes_to_send > 0 and x.remaining_outbound_capacity() > 0) {
+            const size_t want = min({bytes_to_send, chunk.size(), x.remaining_outbound_capacity()});
+            bytes_to_send -= x.write(chunk.substr(0, want));
+        }
+        forward.send(x, now_ms);
+        backward.send(y, now_ms);
+        forward.deliver(y, now_ms);
+        backward.deliver(x, now_ms);
+
+        const size_t available = y.inbound_stream().buffer_size();
+        y.inbound_stream().pop_output(available);
+        bytes_received += available;
+
+        x.tick(1);
+        y.tick(1);
+        ++now_ms;
+    }
+
+    const double megabits_per_second = len * 8.0 / double(now_ms) / 1000;
+
+    cout << fixed << setprecision(2);
+    cout << "Throughput with a " << capacity / 1024 << " KiB window, 50 ms RTT, 1 Gbit/s link, window scaling "
+         << (window_scaling ? "on: " : "off:") << setw(8) << megabits_per_second << " Mbit/s (" << now_ms
+         << " ms simulated)\n";
+}
+
+int main() {
+    try {
+        main_loop(false);
+        main_loop(true);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
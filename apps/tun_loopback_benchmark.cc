@@ -0,0 +1,106 @@
+#include "socket.hh"
+#include "tcp_config.hh"
+#include "tcp_sponge_socket.hh"
+#include "tun.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr const char *TUN_DFLT = "tun144";
+const string TUN_ADDRESS = "169.254.144.1";  // the kernel's end of the TUN device (see tun.sh)
+const string LOCAL_ADDRESS = "169.254.144.9";
+constexpr size_t len = 256 * 1024 * 1024;
+
+//! A TCPOverIPv4SpongeSocket that lets the benchmark count the writes to its TUN device
+class TunCountingSocket : public TCPOverIPv4SpongeSocket {
+  public:
+    using TCPOverIPv4SpongeSocket::TCPOverIPv4SpongeSocket;
+
+    const TunFD &tun() const { return _datagram_adapter; }
+};
+
+//! \returns the user-mode CPU time this process has used so far, in seconds
+static double user_cpu_seconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return double(usage.ru_utime.tv_sec) + double(usage.ru_utime.tv_usec) / 1e6;
+}
+
+//! Send `len` bytes from a sponge TCP connection through the TUN device to a Linux TCP socket listening
+//! on the device's own address, and report the throughput, the user-mode CPU time it took, and how many
+//! writes to the TUN device it took
+void main_loop(const char *tundev, const bool vnet_hdr) {
+    const uint16_t port = 1024 + random_device()() % 60000;
+
+    TCPSocket server;
+    server.set_reuseaddr();
+    server.bind({TUN_ADDRESS, port});
+    server.listen();
+    size_t received = 0;
+    thread receiver([&] {
+        TCPSocket conn = server.accept();
+        while (not conn.eof()) {
+            received += conn.read().size();
+        }
+    });
+
+    TCPConfig c_fsm;
+    c_fsm.recv_capacity = 65000;
+    c_fsm.mss = 1460;  // fills the TUN device's 1500-byte MTU
+    FdAdapterConfig c_filt;
+    c_filt.source = {LOCAL_ADDRESS, to_string(1024 + random_device()() % 60000)};
+    c_filt.destination = {TUN_ADDRESS, to_string(port)};
+
+    TunCountingSocket sock(TCPOverIPv4OverTunFdAdapter(TunFD(tundev, vnet_hdr)));
+    sock.connect(c_fsm, c_filt);
+
+    const string chunk(64 * 1024, 'x');
+    const auto first_time = high_resolution_clock::now();
+    const double first_cpu = user_cpu_seconds();
+    for (size_t written = 0; written < len; written += chunk.size()) {
+        sock.write(chunk);
+    }
+    sock.shutdown(SHUT_WR);
+    receiver.join();
+    const auto final_time = high_resolution_clock::now();
+    const double cpu = user_cpu_seconds() - first_cpu;
+    sock.wait_until_closed();
+    const double writes_per_mib = sock.tun().write_count() * 1048576.0 / double(len);
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+    cout << fixed << setprecision(2);
+    const string mode = vnet_hdr ? "checksums and segmentation offloaded" : "checksums and segmentation in software";
+    cout << left << setw(40) << mode << right << setw(7) << len * 8.0 / double(duration) << " Gbit/s, " << setw(6)
+         << cpu * 1e9 / double(len) << " ns of user CPU per byte, " << setw(6) << writes_per_mib
+         << " TUN writes per MiB";
+    if (received != len) {
+        cout << " (only " << received << " of " << len << " bytes arrived)";
+    }
+    cout << "\n";
+}
+
+int main(int argc, char **argv) {
+    try {
+        if (argc > 2) {
+            cerr << "Usage: " << argv[0] << " [tundev]\n";
+            return EXIT_FAILURE;
+        }
+        const char *tundev = argc == 2 ? argv[1] : TUN_DFLT;
+        main_loop(tundev, false);
+        main_loop(tundev, true);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
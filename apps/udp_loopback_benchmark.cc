@@ -0,0 +1,104 @@
+#include "socket.hh"
+#include "tcp_config.hh"
+#include "tcp_sponge_socket.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+const string LOOPBACK_ADDRESS = "127.0.0.1";
+constexpr size_t len = 256 * 1024 * 1024;
+
+//! A TCPOverUDPSpongeSocket that lets the benchmark count the system calls on its UDP socket
+class UDPCountingSocket : public TCPOverUDPSpongeSocket {
+  public:
+    using TCPOverUDPSpongeSocket::TCPOverUDPSpongeSocket;
+
+    const UDPSocket &udp() const { return _datagram_adapter; }
+};
+
+//! \returns the CPU time, user and system, this process has used so far, in seconds
+static double cpu_seconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+//! Send `len` bytes between two sponge TCP connections over UDP on the loopback interface, and report the
+//! throughput, the CPU time both ends took together, and how many system calls the sender's writes and the
+//! receiver's reads took
+void main_loop(const bool udp_gso) {
+    TCPConfig c_fsm;
+    c_fsm.recv_capacity = 65000;
+    c_fsm.mss = 1460;
+
+    FdAdapterConfig c_server;
+    c_server.source = {LOOPBACK_ADDRESS, uint16_t(1024 + random_device()() % 60000)};
+    c_server.udp_gso = udp_gso;
+    FdAdapterConfig c_client;
+    c_client.source = {LOOPBACK_ADDRESS, uint16_t(1024 + random_device()() % 60000)};
+    c_client.destination = c_server.source;
+    c_client.udp_gso = udp_gso;
+
+    UDPSocket server_udp;
+    server_udp.bind(c_server.source);
+    UDPCountingSocket server(TCPOverUDPSocketAdapter(move(server_udp)));
+    UDPCountingSocket client(TCPOverUDPSocketAdapter(UDPSocket{}));
+
+    size_t received = 0;
+    thread receiver([&] {
+        server.listen_and_accept(c_fsm, c_server);
+        while (not server.eof()) {
+            received += server.read().size();
+        }
+        server.shutdown(SHUT_WR);
+    });
+    client.connect(c_fsm, c_client);
+
+    const string chunk(64 * 1024, 'x');
+    const auto first_time = high_resolution_clock::now();
+    const double first_cpu = cpu_seconds();
+    for (size_t written = 0; written < len; written += chunk.size()) {
+        client.write(chunk);
+    }
+    client.shutdown(SHUT_WR);
+    receiver.join();
+    const auto final_time = high_resolution_clock::now();
+    const double cpu = cpu_seconds() - first_cpu;
+    client.wait_until_closed();
+    server.wait_until_closed();
+
+    const auto duration = duration_cast<nanoseconds>(final_time - first_time).count();
+    const double writes_per_mib = client.udp().write_count() * 1048576.0 / double(len);
+    const double reads_per_mib = server.udp().read_count() * 1048576.0 / double(len);
+    cout << fixed << setprecision(2);
+    cout << left << setw(30) << (udp_gso ? "sendmmsg + UDP_SEGMENT" : "sendmmsg") << right << setw(7)
+         << len * 8.0 / double(duration) << " Gbit/s, " << setw(6) << cpu * 1e9 / double(len)
+         << " ns of CPU per byte, " << setw(7) << writes_per_mib << " sends and " << setw(7)
+         << reads_per_mib << " receives per MiB";
+    if (received != len) {
+        cout << " (only " << received << " of " << len << " bytes arrived)";
+    }
+    cout << "\n";
+}
+
+int main() {
+    try {
+        main_loop(false);
+        main_loop(true);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
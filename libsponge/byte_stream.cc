@@ -1,5 +1,10 @@
 #include "byte_stream.hh"
 
+#include "util.hh"
+
+#include <algorithm>
+#include <cstring>
+
 // Dummy implementation of a flow-controlled in-memory byte stream.
 
 // For Lab 0, please replace with a real implementation that passes the
@@ -12,37 +17,203 @@
 
 using namespace std;
 
-ByteStream::ByteStream(const size_t capacity) : 
+namespace {
+//! Smallest power of two that is >= `n` (and at least 1)
+size_t ring_size_for(const size_t n) {
+    size_t ret = 1;
+    while (ret < n) {
+        ret <<= 1;
+    }
+    return ret;
+}
+
+//! Writes shorter than this share chunks of this size (Storage::Chunks), instead of each getting its own
+constexpr size_t TAIL_CHUNK_SIZE = 4096;
+}  // namespace
+
+//! \details With Storage::Ring the bytes live in a contiguous ring whose size is
+//! rounded up to a power of two, so wrapping is a mask instead of a division and
+//! every write or read touches the storage with at most two memcpy calls.
+//!
+//! With Storage::Chunks the stream keeps a queue of Buffer slices instead. Buffers
+//! written with write(Buffer) are shared rather than copied, and partial pops use
+//! Buffer::remove_prefix(). Short writes are copied into the spare capacity of a shared
+//! TAIL_CHUNK_SIZE chunk, so they cost neither an allocation each nor a queue entry each.
+ByteStream::ByteStream(const size_t capacity, const Storage storage) : 
     _capacity(capacity),
-    _buffer(),
+    _storage(storage),
+    _buffer(storage == Storage::Ring ? ring_size_for(capacity) : 1),
+    _mask(_buffer.size() - 1),
+    _head(0),
+    _chunks(),
+    _tail(),
+    _tail_chunk_start(),
+    _size(0),
     _bytes_written(0),
     _bytes_read(0),
     _error(false),  //!< Flag indicating that the stream suffered an error.
     _close(false)
     {}
 
-size_t ByteStream::write(const string &data) {
+//! \details Both streams may append to their tail, so the copy leaves it behind and starts its own on
+//! its next short write; the chunks they share only ever cover bytes that are already written.
+ByteStream::ByteStream(const ByteStream &other) :
+    _capacity(other._capacity),
+    _storage(other._storage),
+    _buffer(other._buffer),
+    _mask(other._mask),
+    _head(other._head),
+    _chunks(other._chunks),
+    _tail(),
+    _tail_chunk_start(),
+    _size(other._size),
+    _bytes_written(other._bytes_written),
+    _bytes_read(other._bytes_read),
+    _error(other._error),
+    _close(other._close)
+    {}
+
+ByteStream &ByteStream::operator=(const ByteStream &other) {
+    if (this != &other) {
+        *this = ByteStream(other);
+    }
+    return *this;
+}
+
+size_t ByteStream::write(const string &data) { return write_view(data); }
+
+size_t ByteStream::write_view(const string_view data) {
     if(_close || remaining_capacity() == 0)
         return 0;
-    size_t bytes_to_write = min(remaining_capacity(), data.size());
+    const size_t bytes_to_write = min(remaining_capacity(), data.size());
+    if (bytes_to_write == 0)
+        return 0;
+    if (_storage == Storage::Chunks && bytes_to_write >= TAIL_CHUNK_SIZE) {
+        _chunks.emplace_back(string(data.substr(0, bytes_to_write)));
+        _tail_chunk_start.reset();
+    } else if (_storage == Storage::Chunks) {
+        append_to_tail(data.substr(0, bytes_to_write));
+    } else {
+        stage(0, data.substr(0, bytes_to_write));
+    }
+    _size += bytes_to_write;
+    _bytes_written += bytes_to_write;
+    return bytes_to_write;
+}
+
+//! \param[in] data is a short write, copied after the bytes already in `_tail`
+//! \details Bytes are only ever added past the end of `_tail`, and never beyond its capacity, so
+//! slices of it that are already queued or handed out (e.g. as segment payloads) stay valid.
+void ByteStream::append_to_tail(const string_view data) {
+    if (not _tail or _tail->size() + data.size() > _tail->capacity()) {
+        _tail = make_shared<string>();
+        _tail->reserve(TAIL_CHUNK_SIZE);
+        _tail_chunk_start.reset();
+    }
+    const size_t offset = _tail->size();
+    _tail->append(data);
+    // grow the last chunk if it is the slice of `_tail` that ends where the new bytes begin (a partial pop
+    // of it moves its start, so it no longer does); otherwise queue a new slice
+    if (offset > 0 and _tail_chunk_start.has_value() and not _chunks.empty() and
+        _chunks.back().shares_storage(_tail) and _tail_chunk_start.value() + _chunks.back().size() == offset) {
+        _chunks.back() = Buffer{_tail, _tail_chunk_start.value(), offset - _tail_chunk_start.value() + data.size()};
+    } else {
+        _tail_chunk_start = offset;
+        _chunks.emplace_back(_tail, offset, data.size());
+    }
+}
+
+//! \param[in] offset is the distance past the last written byte where `data` starts
+//! \param[in] data is the bytes to place; anything past the remaining capacity is dropped
+//! \details Staged bytes are overwritten by a later write(), so the caller must
+//! commit() them (or keep staging) before writing through the normal interface.
+size_t ByteStream::stage(const size_t offset, const string_view data) {
+    if (_storage != Storage::Ring || _close || offset >= remaining_capacity())
+        return 0;
+    const size_t len = min(data.size(), remaining_capacity() - offset);
+    // copy into [pos, end of ring) and then wrap around to the front
+    const size_t pos = (_head + _size + offset) & _mask;
+    const size_t first = min(len, _buffer.size() - pos);
+    memcpy(&_buffer[pos], data.data(), first);
+    memcpy(_buffer.data(), data.data() + first, len - first);
+    return len;
+}
+
+//! \param[in] len is the number of staged bytes to publish
+void ByteStream::commit(const size_t len) {
+    const size_t committed = min(len, remaining_capacity());
+    _size += committed;
+    _bytes_written += committed;
+}
+
+//! \param[in] data is the Buffer to append; only the part that fits is accepted
+size_t ByteStream::write(Buffer data) {
+    if (_storage == Storage::Ring || data.size() > remaining_capacity())
+        return write_view(data.str());
+    const size_t bytes_to_write = data.size();
+    if (_close || bytes_to_write == 0)
+        return 0;
+    _chunks.push_back(move(data));
+    _tail_chunk_start.reset();
+    _size += bytes_to_write;
     _bytes_written += bytes_to_write;
-    for(size_t i = 0; i < bytes_to_write; i++)
-        _buffer.push_back(data[i]);
     return bytes_to_write;
 }
 
 //! \param[in] len bytes will be copied from the output side of the buffer
 string ByteStream::peek_output(const size_t len) const {
-    size_t pop_len = min(len, _buffer.size());
-    return string(_buffer.begin(),_buffer.begin() + pop_len );
+    const size_t peek_len = min(len, _size);
+    string ret;
+    ret.reserve(peek_len);
+    if (_storage == Storage::Chunks) {
+        for (auto it = _chunks.begin(); ret.size() < peek_len; ++it) {
+            ret.append(it->str().substr(0, peek_len - ret.size()));
+        }
+        return ret;
+    }
+    const size_t first = min(peek_len, _buffer.size() - _head);
+    ret.append(&_buffer[_head], first);
+    ret.append(_buffer.data(), peek_len - first);
+    return ret;
+}
+
+//! \param[in] len bytes will be exposed from the output side of the buffer
+BufferViewList ByteStream::peek_output_views(const size_t len) const {
+    const size_t peek_len = min(len, _size);
+    if (_storage == Storage::Chunks) {
+        BufferViewList ret{};
+        size_t viewed = 0;
+        for (auto it = _chunks.begin(); viewed < peek_len; ++it) {
+            const string_view view = it->str().substr(0, peek_len - viewed);
+            ret.append(view);
+            viewed += view.size();
+        }
+        return ret;
+    }
+    const size_t first = min(peek_len, _buffer.size() - _head);
+    BufferViewList ret{string_view(&_buffer[_head], first)};
+    ret.append(string_view(_buffer.data(), peek_len - first));
+    return ret;
 }
 
 //! \param[in] len bytes will be removed from the output side of the buffer
 void ByteStream::pop_output(const size_t len) { 
-    size_t pop_size = min(len, _buffer.size());
+    const size_t pop_size = min(len, _size);
+    if (_storage == Storage::Chunks) {
+        size_t remaining = pop_size;
+        while (remaining > 0) {
+            if (remaining < _chunks.front().size()) {
+                _chunks.front().remove_prefix(remaining);
+                break;
+            }
+            remaining -= _chunks.front().size();
+            _chunks.pop_front();
+        }
+    } else {
+        _head = (_head + pop_size) & _mask;
+    }
+    _size -= pop_size;
     _bytes_read += pop_size;
-    for (size_t i = 0; i < pop_size; i++)
-        _buffer.pop_front();
 }
 
 //! Read (i.e., copy and then pop) the next "len" bytes of the stream
@@ -54,18 +225,74 @@ std::string ByteStream::read(const size_t len) {
     return data;
 }
 
+//! \param[in] len bytes will be popped and returned
+//! \returns a BufferList; a chunk that is split by `len` is sliced, so nothing is copied
+BufferList ByteStream::read_buffers(const size_t len) {
+    if (_storage == Storage::Ring)
+        return BufferList(read(len));
+    const size_t read_len = min(len, _size);
+    BufferList ret;
+    size_t taken = 0;
+    while (taken < read_len) {
+        const size_t want = read_len - taken;
+        if (want < _chunks.front().size()) {
+            ret.append(_chunks.front().substr(0, want));
+            _chunks.front().remove_prefix(want);
+            taken += want;
+            break;
+        }
+        taken += _chunks.front().size();
+        ret.append(move(_chunks.front()));
+        _chunks.pop_front();
+    }
+    _size -= read_len;
+    _bytes_read += read_len;
+    return ret;
+}
+
+//! \param[in] len bytes will be popped and returned
+Buffer ByteStream::read_buffer(const size_t len) {
+    const size_t read_len = min(len, _size);
+    if (read_len == 0) {
+        return {};
+    }
+    if (_storage == Storage::Chunks && read_len <= _chunks.front().size()) {
+        Buffer ret = _chunks.front().substr(0, read_len);
+        pop_output(read_len);
+        return ret;
+    }
+
+    // the bytes have to be copied anyway, so checksum them in the same pass
+    string ret(read_len, 0);
+    InternetChecksum check;
+    if (_storage == Storage::Chunks) {
+        size_t copied = 0;
+        for (auto it = _chunks.begin(); copied < read_len; ++it) {
+            const string_view chunk = it->str().substr(0, read_len - copied);
+            check.add_copy(ret.data() + copied, chunk);
+            copied += chunk.size();
+        }
+    } else {
+        const size_t first = min(read_len, _buffer.size() - _head);
+        check.add_copy(ret.data(), {&_buffer[_head], first});
+        check.add_copy(ret.data() + first, {_buffer.data(), read_len - first});
+    }
+    pop_output(read_len);
+    return Buffer(move(ret), check.sum());
+}
+
 void ByteStream::end_input() { _close = true;}
 
 bool ByteStream::input_ended() const { return _close == true; }
 
-size_t ByteStream::buffer_size() const { return _buffer.size(); }
+size_t ByteStream::buffer_size() const { return _size; }
 
-bool ByteStream::buffer_empty() const { return _buffer.empty(); }
+bool ByteStream::buffer_empty() const { return _size == 0; }
 
-bool ByteStream::eof() const { return _close && _buffer.size() == 0; }
+bool ByteStream::eof() const { return _close && _size == 0; }
 
 size_t ByteStream::bytes_written() const { return _bytes_written; }
 
 size_t ByteStream::bytes_read() const { return _bytes_read; }
 
-size_t ByteStream::remaining_capacity() const { return _capacity - _buffer.size(); }
+size_t ByteStream::remaining_capacity() const { return _capacity - _size; }
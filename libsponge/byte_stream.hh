@@ -1,17 +1,28 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
-#include <string>
+#include "buffer.hh"
+
 #include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
-#include <deque>
+#include <vector>
 //! \brief An in-order byte stream.
 
 //! Bytes are written on the "input" side and read from the "output"
 //! side.  The byte stream is finite: the writer can end the input,
 //! and then no more bytes can be written.
 class ByteStream {
+  public:
+    //! How the stream holds the bytes it has buffered
+    enum class Storage {
+        Ring,   //!< copied into a contiguous power-of-two ring (the default)
+        Chunks  //!< queued as refcounted Buffer slices, so bytes are copied at most once, on the way in
+    };
+
   private:
     // Your code here -- add private members as necessary.
 
@@ -20,15 +31,32 @@ class ByteStream {
     // that's a sign that you probably want to keep exploring
     // different approaches.
     size_t _capacity;
-    std::deque<char> _buffer; // buffer for the stream
+    Storage _storage;
+    std::vector<char> _buffer;  //!< ring storage, size is a power of two >= `_capacity`
+    size_t _mask;               //!< `_buffer.size() - 1`, maps a position to its slot
+    size_t _head;               //!< slot of the next byte to be read
+    std::deque<Buffer> _chunks;  //!< queued slices when `_storage` is Storage::Chunks
+    std::shared_ptr<std::string> _tail;  //!< storage that short writes are appended to, with Storage::Chunks
+    std::optional<size_t> _tail_chunk_start;  //!< where the last chunk starts in `_tail`, if it was cut from it
+    size_t _size;               //!< number of bytes currently buffered
     size_t _bytes_written;
     size_t _bytes_read;
     bool _error;  //!< Flag indicating that the stream suffered an error.
     bool _close;
 
+    //! Copy a short write into the shared tail chunk (Storage::Chunks)
+    void append_to_tail(const std::string_view data);
+
   public:
     //! Construct a stream with room for `capacity` bytes.
-    ByteStream(const size_t capacity);
+    ByteStream(const size_t capacity, const Storage storage = Storage::Ring);
+
+    //! A copy shares the queued chunks, but not the tail that short writes are appended to
+    ByteStream(const ByteStream &other);
+    ByteStream &operator=(const ByteStream &other);
+    ByteStream(ByteStream &&other) = default;
+    ByteStream &operator=(ByteStream &&other) = default;
+    ~ByteStream() = default;
 
     //! \name "Input" interface for the writer
     //!@{
@@ -38,9 +66,27 @@ class ByteStream {
     //! \returns the number of bytes accepted into the stream
     size_t write(const std::string &data);
 
+    //! Write a std::string_view of bytes into the stream. Write as many
+    //! as will fit, and return how many were written.
+    //! \returns the number of bytes accepted into the stream
+    size_t write_view(const std::string_view data);
+
+    //! Write a refcounted Buffer into the stream. With Storage::Chunks the
+    //! Buffer is queued as-is whenever it fits entirely, so no bytes are copied.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(Buffer data);
+
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
 
+    //! Copy `data` into the free space `offset` bytes past the end of the stream,
+    //! without making it readable yet (Storage::Ring only).
+    //! \returns the number of bytes staged (clipped to the remaining capacity)
+    size_t stage(const size_t offset, const std::string_view data);
+
+    //! Make the next `len` staged bytes readable, as if they had just been written
+    void commit(const size_t len);
+
     //! Signal that the byte stream has reached its ending
     void end_input();
 
@@ -55,6 +101,11 @@ class ByteStream {
     //! \returns a string
     std::string peek_output(const size_t len) const;
 
+    //! Peek at next "len" bytes of the stream without copying them
+    //! \returns one or two views into the stream's storage (two if the bytes wrap around)
+    //! \note The views are only valid until the next write or pop on this stream.
+    BufferViewList peek_output_views(const size_t len) const;
+
     //! Remove bytes from the buffer
     void pop_output(const size_t len);
 
@@ -62,6 +113,15 @@ class ByteStream {
     //! \returns a string
     std::string read(const size_t len);
 
+    //! Read (i.e., take and then pop) the next "len" bytes of the stream as Buffers
+    //! \returns a BufferList; with Storage::Chunks it shares the queued Buffers instead of copying them
+    BufferList read_buffers(const size_t len);
+
+    //! Read (i.e., take and then pop) the next "len" bytes of the stream as one Buffer
+    //! \returns with Storage::Chunks, a slice of the first queued Buffer when the bytes lie within it
+    //! (no copy); otherwise a copy, checksummed as it is made (see Buffer::partial_checksum)
+    Buffer read_buffer(const size_t len);
+
     //! \returns `true` if the stream input has ended
     bool input_ended() const;
 
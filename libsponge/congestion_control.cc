@@ -0,0 +1,211 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace {
+
+//! RFC 5681 section 3.1: the initial window is 2 to 4 segments, depending on the MSS
+size_t initial_window(const size_t mss) {
+    if (mss > 2190) {
+        return 2 * mss;
+    }
+    if (mss > 1095) {
+        return 3 * mss;
+    }
+    return 4 * mss;
+}
+
+class NoCongestionControl : public CongestionControl {
+  public:
+    void on_ack(const size_t, const optional<uint64_t>, const uint64_t) override {}
+    void on_loss(const size_t, const uint64_t) override {}
+    void on_rto(const size_t, const uint64_t) override {}
+    size_t cwnd() const override { return numeric_limits<size_t>::max(); }
+    string name() const override { return "none"; }
+};
+
+//! Slow start, congestion avoidance with appropriate byte counting (RFC 3465), and
+//! multiplicative decrease on loss.
+class Reno : public CongestionControl {
+    size_t _mss;
+    size_t _cwnd;
+    size_t _ssthresh = numeric_limits<size_t>::max();
+    size_t _acked_in_avoidance = 0;  //!< bytes acked since cwnd last grew by one MSS in congestion avoidance
+
+  public:
+    explicit Reno(const size_t mss) : _mss(mss), _cwnd(initial_window(mss)) {}
+
+    void on_ack(const size_t bytes_acked, const optional<uint64_t>, const uint64_t) override {
+        if (_cwnd < _ssthresh) {
+            _cwnd += min(bytes_acked, _mss);
+            return;
+        }
+        _acked_in_avoidance += bytes_acked;
+        if (_acked_in_avoidance >= _cwnd) {
+            _acked_in_avoidance -= _cwnd;
+            _cwnd += _mss;
+        }
+    }
+
+    void on_loss(const size_t bytes_in_flight, const uint64_t) override {
+        _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+        _cwnd = _ssthresh;
+        _acked_in_avoidance = 0;
+    }
+
+    void on_rto(const size_t bytes_in_flight, const uint64_t) override {
+        _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+        _cwnd = _mss;
+        _acked_in_avoidance = 0;
+    }
+
+    size_t cwnd() const override { return _cwnd; }
+    string name() const override { return "reno"; }
+};
+
+//! CUBIC (RFC 9438): after a loss the window follows W(t) = C*(t-K)^3 + W_max,
+//! flattening out around the window where the loss happened, and never grows
+//! slower than Reno would (the "Reno-friendly" estimate).
+class Cubic : public CongestionControl {
+    static constexpr double C = 0.4;     //!< in segments per second cubed
+    static constexpr double BETA = 0.7;  //!< multiplicative decrease factor
+
+    double _mss;
+    double _cwnd;
+    double _ssthresh = numeric_limits<double>::infinity();
+    double _w_max = 0;                  //!< window at the last loss, in bytes
+    double _origin = 0;                 //!< plateau of the current cubic curve, in bytes
+    double _k = 0;                      //!< seconds from the epoch start to the plateau
+    double _w_est = 0;                  //!< Reno-friendly window estimate, in bytes
+    optional<uint64_t> _epoch_start{};  //!< when the current congestion-avoidance epoch began
+    optional<uint64_t> _min_rtt{};
+
+    void reduce() {
+        // fast convergence: give up bandwidth sooner if the last loss came at a smaller window
+        _w_max = _cwnd < _w_max ? _cwnd * (1 + BETA) / 2 : _cwnd;
+        _ssthresh = max(_cwnd * BETA, 2 * _mss);
+        _epoch_start.reset();
+    }
+
+  public:
+    explicit Cubic(const size_t mss) : _mss(double(mss)), _cwnd(double(initial_window(mss))) {}
+
+    void on_ack(const size_t bytes_acked, const optional<uint64_t> rtt_ms, const uint64_t now_ms) override {
+        if (rtt_ms.has_value()) {
+            _min_rtt = min(rtt_ms.value(), _min_rtt.value_or(rtt_ms.value()));
+        }
+        if (_cwnd < _ssthresh) {
+            _cwnd += min(double(bytes_acked), _mss);
+            return;
+        }
+        if (not _epoch_start.has_value()) {
+            _epoch_start = now_ms;
+            if (_cwnd < _w_max) {
+                _k = cbrt((_w_max - _cwnd) / _mss / C);
+                _origin = _w_max;
+            } else {
+                _k = 0;
+                _origin = _cwnd;
+            }
+            _w_est = _cwnd;
+        }
+        const double t = double(now_ms - _epoch_start.value() + _min_rtt.value_or(0)) / 1000;
+        const double target = clamp(_origin + C * pow(t - _k, 3) * _mss, _cwnd, 1.5 * _cwnd);
+        _w_est += 3 * (1 - BETA) / (1 + BETA) * _mss * double(bytes_acked) / _cwnd;
+        _cwnd += (max(target, _w_est) - _cwnd) * double(bytes_acked) / _cwnd;
+    }
+
+    void on_loss(const size_t, const uint64_t) override {
+        reduce();
+        _cwnd = _ssthresh;
+    }
+
+    void on_rto(const size_t, const uint64_t) override {
+        reduce();
+        _cwnd = _mss;
+    }
+
+    size_t cwnd() const override { return size_t(_cwnd); }
+    string name() const override { return "cubic"; }
+};
+
+//! TCP Vegas: compare the RTT of each timed segment with the smallest RTT seen, and
+//! estimate how many of our segments are sitting in queues. Keep that between
+//! ALPHA and BETA by adding or removing one segment per round trip.
+class Delay : public CongestionControl {
+    static constexpr size_t ALPHA = 2;  //!< grow while fewer segments than this are queued
+    static constexpr size_t BETA = 4;   //!< shrink while more segments than this are queued
+    static constexpr size_t GAMMA = 1;  //!< leave slow start once this many segments are queued
+
+    size_t _mss;
+    size_t _cwnd;
+    size_t _ssthresh = numeric_limits<size_t>::max();
+    optional<uint64_t> _base_rtt{};
+    optional<uint64_t> _round_min_rtt{};  //!< smallest RTT sample since the last adjustment
+    uint64_t _round_end_ms = 0;           //!< no adjustment before this time
+
+  public:
+    explicit Delay(const size_t mss) : _mss(mss), _cwnd(initial_window(mss)) {}
+
+    void on_ack(const size_t bytes_acked, const optional<uint64_t> rtt_ms, const uint64_t now_ms) override {
+        if (_cwnd < _ssthresh) {
+            _cwnd += min(bytes_acked, _mss);
+        }
+        if (not rtt_ms.has_value() or rtt_ms.value() == 0) {
+            return;
+        }
+        _base_rtt = min(rtt_ms.value(), _base_rtt.value_or(rtt_ms.value()));
+        _round_min_rtt = min(rtt_ms.value(), _round_min_rtt.value_or(rtt_ms.value()));
+        // adjust once per round trip, from the smallest sample of the round
+        if (now_ms < _round_end_ms) {
+            return;
+        }
+        const uint64_t rtt = _round_min_rtt.value();
+        _round_min_rtt.reset();
+        _round_end_ms = now_ms + rtt;
+        const size_t queued = _cwnd * (rtt - _base_rtt.value()) / rtt / _mss;
+        if (_cwnd < _ssthresh) {
+            if (queued > GAMMA) {
+                _ssthresh = _cwnd;
+            }
+        } else if (queued < ALPHA) {
+            _cwnd += _mss;
+        } else if (queued > BETA and _cwnd > 2 * _mss) {
+            _cwnd -= _mss;
+            _ssthresh = _cwnd;  // don't slow-start back up
+        }
+    }
+
+    void on_loss(const size_t, const uint64_t) override {
+        _ssthresh = max(_cwnd * 3 / 4, 2 * _mss);
+        _cwnd = _ssthresh;
+    }
+
+    void on_rto(const size_t bytes_in_flight, const uint64_t) override {
+        _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+        _cwnd = _mss;
+    }
+
+    size_t cwnd() const override { return _cwnd; }
+    string name() const override { return "delay"; }
+};
+
+}  // namespace
+
+unique_ptr<CongestionControl> CongestionControl::make(const Algorithm algorithm, const size_t mss) {
+    switch (algorithm) {
+        case Algorithm::Reno:
+            return make_unique<Reno>(mss);
+        case Algorithm::Cubic:
+            return make_unique<Cubic>(mss);
+        case Algorithm::Delay:
+            return make_unique<Delay>(mss);
+        case Algorithm::None:
+            break;
+    }
+    return make_unique<NoCongestionControl>();
+}
@@ -0,0 +1,50 @@
+#ifndef SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+#define SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+//! \brief The congestion window of a TCPSender, and the algorithm that moves it.
+
+//! The TCPSender reports cumulative ACKs, detected losses and retransmission
+//! timeouts; the algorithm answers with a window (in bytes) that bounds the
+//! bytes in flight alongside the receiver's advertised window.
+class CongestionControl {
+  public:
+    //! Which algorithm a TCPSender runs
+    enum class Algorithm {
+        None,   //!< no congestion window: send whatever the receiver's window allows (the default)
+        Reno,   //!< slow start and additive increase, halve on loss (RFC 5681)
+        Cubic,  //!< cubic window growth around the last loss point (RFC 9438)
+        Delay   //!< delay-based: grow while the RTT stays near its minimum, shrink as a queue builds (Vegas)
+    };
+
+    //! \brief Construct the congestion controller for `algorithm`
+    //! \param mss the sender's maximum segment size, in bytes
+    static std::unique_ptr<CongestionControl> make(const Algorithm algorithm, const size_t mss);
+
+    virtual ~CongestionControl() = default;
+
+    //! \brief Bytes were cumulatively acknowledged
+    //! \param bytes_acked newly acknowledged sequence space
+    //! \param rtt_ms a round-trip sample taken from this ACK, if there was one
+    //! \param now_ms the sender's clock
+    virtual void on_ack(const size_t bytes_acked, const std::optional<uint64_t> rtt_ms, const uint64_t now_ms) = 0;
+
+    //! \brief A loss was detected without a timeout (at most once per window of data)
+    virtual void on_loss(const size_t bytes_in_flight, const uint64_t now_ms) = 0;
+
+    //! \brief The retransmission timer expired
+    virtual void on_rto(const size_t bytes_in_flight, const uint64_t now_ms) = 0;
+
+    //! \brief The congestion window, in bytes
+    virtual size_t cwnd() const = 0;
+
+    //! \brief Name of the algorithm, for logging
+    virtual std::string name() const = 0;
+};
+
+#endif  // SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
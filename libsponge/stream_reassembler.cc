@@ -13,12 +13,15 @@ void DUMMY_CODE(Targs &&... /* unused */) {}
 
 using namespace std;
 
-StreamReassembler::StreamReassembler(const size_t capacity) : 
-    _output(capacity), 
+StreamReassembler::StreamReassembler(const size_t capacity, const ByteStream::Storage storage, const Mode mode) : 
+    _output(capacity, mode == Mode::Window ? ByteStream::Storage::Ring : storage), 
     _capacity(capacity),
+    _mode(mode),
     _segments(),
+    _ranges(),
     _pending_bytes(0),  //!< total bytes in _segments
     _first_unassembled(0),  //!< next index needed
+    _last_stored(0),
     _eof_index()
     {}
 // Trim the assembly window to keep memory <= capacity and close if done.
@@ -27,17 +30,23 @@ void StreamReassembler::try_close_if_done_() {
         _output.end_input();
     }
 }
+// Remember where the stream ends (the earliest claim wins).
+void StreamReassembler::record_eof_(const uint64_t end) {
+    if (_eof_index.has_value())
+        _eof_index = min(*_eof_index, end);
+    else
+        _eof_index = end;
+}
 //! \details This function accepts a substring (aka a segment) of bytes,
 //! possibly out-of-order, from the logical stream, and assembles any newly
 //! contiguous substrings and writes them into the output stream in order.
 void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
-    if (eof) {
-        const uint64_t end = index + data.size();
-        if (_eof_index.has_value())
-            _eof_index = min(*_eof_index, end);
-        else
-            _eof_index = end;
-    }
+    push_view_(data, index, eof);
+}
+
+void StreamReassembler::push_view_(const string_view data, const uint64_t index, const bool eof) {
+    if (eof)
+        record_eof_(index + data.size());
 
     if (data.empty()) {
         try_close_if_done_();
@@ -76,14 +85,27 @@ void StreamReassembler::push_substring(const string &data, const size_t index, c
     // if (seg_l < _first_unassembled) seg_l = _first_unassembled;
 
     // Extract the kept substring
-    string piece = data.substr(seg_l - index, seg_r - seg_l);
-    if (piece.empty()) {
-        try_close_if_done_();
-        return;
-    }
+    const string_view kept = data.substr(seg_l - index, seg_r - seg_l);
+    if (seg_l == _first_unassembled && empty()) {
+        // In order with nothing pending: nothing to merge, so write it straight through.
+        // The window clip above guarantees that it all fits.
+        _first_unassembled += _output.write_view(kept);
+    } else if (_mode == Mode::Window)
+        insert_window_(seg_l, kept);
+    else
+        insert_segment_(seg_l, kept);
+
+    // Maybe we can close now
+    try_close_if_done_();
+}
+
+// Mode::Map: store `kept` (which starts at index `seg_l`) in _segments, then flush what is contiguous.
+void StreamReassembler::insert_segment_(const uint64_t seg_l, const string_view kept) {
+    string piece(kept);
+    _last_stored = seg_l;
 
     // Insert into _segments and merge with neighbors, maintaining non-overlapping invariant
-    uint64_t L = seg_l, R = seg_r;
+    uint64_t L = seg_l, R = seg_l + piece.size();
     auto it = _segments.lower_bound(L);
 
     // Merge with left neighbor if overlaps/touches
@@ -153,11 +175,82 @@ void StreamReassembler::push_substring(const string &data, const size_t index, c
             break;
         }
     }
+}
 
-    // Maybe we can close now
+// Mode::Window: copy only the bytes of `kept` that are not already held straight into their
+// final slots in the output ring, merge the range set, and commit the range at the front.
+void StreamReassembler::insert_window_(const uint64_t seg_l, const string_view kept) {
+    const uint64_t seg_r = seg_l + kept.size();
+    uint64_t L = seg_l, R = seg_r;
+    uint64_t cursor = seg_l;  // first byte of `kept` not yet known to be held
+    _last_stored = seg_l;
+
+    auto it = _ranges.upper_bound(seg_l);
+    if (it != _ranges.begin() && std::prev(it)->second >= seg_l)
+        --it;
+    // every range that overlaps or touches [seg_l, seg_r) is absorbed into one
+    while (it != _ranges.end() && it->first <= seg_r) {
+        if (it->first > cursor)
+            _output.stage(cursor - _first_unassembled, kept.substr(cursor - seg_l, it->first - cursor));
+        cursor = max(cursor, it->second);
+        L = min(L, it->first);
+        R = max(R, it->second);
+        _pending_bytes -= it->second - it->first;
+        it = _ranges.erase(it);
+    }
+    if (cursor < seg_r)
+        _output.stage(cursor - _first_unassembled, kept.substr(cursor - seg_l));
+
+    if (L == _first_unassembled) {
+        // the bytes are already in place: just make them readable
+        _output.commit(R - L);
+        _first_unassembled = R;
+    } else {
+        _ranges.emplace(L, R);
+        _pending_bytes += R - L;
+    }
+}
+
+//! \details If the Buffer covers the first unassembled byte and no other substrings are
+//! waiting, its new suffix is written straight into the output stream (with
+//! ByteStream::Storage::Chunks that shares the Buffer instead of copying it).
+//! Anything else takes the general path through `_segments`.
+void StreamReassembler::push_substring(const Buffer &data, const size_t index, const bool eof) {
+    const uint64_t end = index + data.size();
+    if (!empty() || index > _first_unassembled || end <= _first_unassembled) {
+        push_view_(data.str(), index, eof);
+        return;
+    }
+    if (eof)
+        record_eof_(end);
+
+    Buffer in_order = data;
+    in_order.remove_prefix(_first_unassembled - index);
+    _first_unassembled += _output.write(move(in_order));
     try_close_if_done_();
 }
 
+//! \details The first range is the one a SACK receiver must report first (RFC 2018, section 4).
+vector<pair<uint64_t, uint64_t>> StreamReassembler::held_ranges(const size_t max_ranges) const {
+    vector<pair<uint64_t, uint64_t>> all;
+    if (_mode == Mode::Window) {
+        all.assign(_ranges.begin(), _ranges.end());
+    } else {
+        for (const auto &[begin, piece] : _segments)
+            all.emplace_back(begin, begin + piece.size());
+    }
+
+    // move the range holding the most recent substring to the front
+    auto latest = find_if(all.begin(), all.end(), [&](const auto &r) {
+        return r.first <= _last_stored && _last_stored < r.second;
+    });
+    if (latest != all.end())
+        rotate(all.begin(), latest, latest + 1);
+
+    all.resize(min(all.size(), max_ranges));
+    return all;
+}
+
 size_t StreamReassembler::unassembled_bytes() const { return _pending_bytes; }
 
 bool StreamReassembler::empty() const { return _pending_bytes == 0; }
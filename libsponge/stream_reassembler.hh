@@ -1,30 +1,51 @@
 #ifndef SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 #define SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 
+#include "buffer.hh"
 #include "byte_stream.hh"
 #include <map>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <utility>
+#include <vector>
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
 //! possibly overlapping) into an in-order byte stream.
 class StreamReassembler {
+  public:
+    //! How bytes that arrive out of order are held until they can be assembled
+    enum class Mode {
+        Map,    //!< substrings in a map keyed by index, merged with their neighbours (the default)
+        Window  //!< bytes staged directly in the output stream's ring, plus a set of held ranges
+    };
+
   private:
     // Your code here -- add private members as necessary.
 
     ByteStream _output;  //!< The reassembled in-order byte stream
     size_t _capacity;    //!< The maximum number of bytes
+    Mode _mode;
     std::map<size_t, std::string> _segments; // index + string
-    size_t _pending_bytes;  //!< total bytes in _segments
+    std::map<uint64_t, uint64_t> _ranges;  //!< Mode::Window: held [begin, end) index ranges
+    size_t _pending_bytes;  //!< total bytes in _segments (or _ranges)
     size_t _first_unassembled;  //!< next index needed
+    uint64_t _last_stored;  //!< index of the most recently stored out-of-order substring
     std::optional<size_t> _eof_index;
 
     void try_close_if_done_();
+    void record_eof_(const uint64_t end);
+    void push_view_(const std::string_view data, const uint64_t index, const bool eof);
+    void insert_segment_(const uint64_t seg_l, const std::string_view kept);
+    void insert_window_(const uint64_t seg_l, const std::string_view kept);
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
     //! \note This capacity limits both the bytes that have been reassembled,
     //! and those that have not yet been reassembled.
-    StreamReassembler(const size_t capacity);
+    //! \note Mode::Window always uses ByteStream::Storage::Ring for the output stream.
+    StreamReassembler(const size_t capacity,
+                      const ByteStream::Storage storage = ByteStream::Storage::Ring,
+                      const Mode mode = Mode::Map);
 
     //! \brief Receive a substring and write any newly contiguous bytes into the stream.
     //!
@@ -36,6 +57,12 @@ class StreamReassembler {
     //! \param eof the last byte of `data` will be the last byte in the entire stream
     void push_substring(const std::string &data, const uint64_t index, const bool eof);
 
+    //! \brief Receive a substring held in a refcounted Buffer.
+    //!
+    //! Behaves like the std::string version, but an in-order Buffer that arrives while
+    //! nothing else is pending is handed to the output stream without being copied.
+    void push_substring(const Buffer &data, const uint64_t index, const bool eof);
+
     //! \name Access the reassembled byte stream
     //!@{
     const ByteStream &stream_out() const { return _output; }
@@ -48,6 +75,11 @@ class StreamReassembler {
     //! should only be counted once for the purpose of this function.
     size_t unassembled_bytes() const;
 
+    //! \brief The ranges of bytes stored but not yet reassembled (e.g. to build SACK blocks)
+    //! \returns up to `max_ranges` [begin, end) index ranges. The range holding the most recently
+    //! stored substring comes first; the rest follow in stream order.
+    std::vector<std::pair<uint64_t, uint64_t>> held_ranges(const size_t max_ranges) const;
+
     //! \brief Is the internal state empty (other than the output stream)?
     //! \returns `true` if no substrings are waiting to be assembled
     bool empty() const;
@@ -12,6 +12,13 @@ void DUMMY_CODE(Targs &&... /* unused */) {}
 
 using namespace std;
 
+TCPConnection::TCPConnection(const TCPConfig &cfg) : _cfg{cfg} {
+    // 选最小的 shift，使窗口字段能表示整个 recv_capacity
+    while (_rcv_window_scale < MAX_WINDOW_SCALE &&
+           (_cfg.recv_capacity >> _rcv_window_scale) > numeric_limits<uint16_t>::max())
+        ++_rcv_window_scale;
+}
+
 size_t TCPConnection::remaining_outbound_capacity() const { return _sender.stream_in().remaining_capacity(); }
 
 size_t TCPConnection::bytes_in_flight() const { return _sender.bytes_in_flight(); }
@@ -34,17 +41,46 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
         _active = false;
         return;
     }
-    // 处理收到的seg
-    _receiver.segment_received(seg);
+    // 对端在SYN上提供了SACK
+    if (seg.header().syn && seg.header().sack_permitted && _cfg.sack)
+        _sack_ok = true;
+    // 对端在SYN上通告的MSS，发送的段不能超过它
+    if (seg.header().syn && seg.header().mss.has_value())
+        _sender.set_peer_mss(seg.header().mss.value());
+    // 对端在SYN上提供了窗口缩放
+    if (seg.header().syn && seg.header().window_scale.has_value() && _cfg.window_scaling)
+        _window_scale_ok = true;
+
+    // 延迟ACK要知道这个段是不是恰好接在已收到的数据后面
+    const optional<WrappingInt32> ackno_before = _receiver.ackno();
+    const size_t unassembled_before = _receiver.unassembled_bytes();
+
+    // 处理收到的seg；PAWS 丢弃的旧重复段只回一个ACK，其ACK字段也不处理
+    if (!_receiver.segment_received(seg)) {
+        _sender.send_empty_segment();
+        send_segment_with_ack_win();
+        return;
+    }
 
     // ACK Flag is set
     if(seg.header().ack){
-        _sender.ack_received(seg.header().ackno, seg.header().win);
+        const bool pure_ack = seg.length_in_sequence_space() == 0;
+        // 协商了时间戳时，把对端回显的 TSecr 交给 sender 采样 RTT
+        optional<uint32_t> ts_ecr;
+        if (_receiver.ts_recent().has_value() && seg.header().timestamps.has_value())
+            ts_ecr = seg.header().timestamps->second;
+        if (_sack_ok)
+            _sender.ack_received(seg.header().ackno, seg.header().win, seg.header().sack, pure_ack, ts_ecr);
+        else
+            _sender.ack_received(seg.header().ackno, seg.header().win, {}, pure_ack, ts_ecr);
         // _sender.fill_window(); // 这行其实是多余的，因为已经在 ack_received 中被调用了，不过这里显示说明一下其操作
         // 如果原本需要发送空ack，并且此时 sender 发送了新数据，则停止发送空ack
         if (need_empty_ack && !_sender.segments_out().empty())
             need_empty_ack = false;
     }
+    // SYN 段自身的窗口字段不缩放，所以处理完它的 ACK 之后才开始对对端窗口做缩放
+    if (seg.header().syn && _window_scale_ok)
+        _sender.set_window_scale(min(seg.header().window_scale.value(), MAX_WINDOW_SCALE));
     //_sender.fill_window(); // called in _sender.ack_received()
     // 如果是 LISEN 到了 SYN
     if (TCPState::state_summary(_receiver) == TCPReceiverStateSummary::SYN_RECV &&
@@ -87,6 +123,14 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
         need_empty_ack = true;
     }
 
+    // 延迟ACK：按序到达的数据段攒到第二个再回，或者等 tick() 里的定时器到期；
+    // 乱序、重复、填洞的段以及 SYN/FIN 都要立即回ACK
+    if (need_empty_ack && _cfg.delayed_ack && ackno_before.has_value() && seg.header().seqno == ackno_before.value() &&
+        unassembled_before == 0 && _receiver.unassembled_bytes() == 0 && !seg.header().syn && !seg.header().fin) {
+        if (++_segments_unacked < 2)
+            need_empty_ack = false;
+    }
+
      // 如果收到的数据包里没有任何数据，则这个数据包可能只是为了 keep-alive
     if (need_empty_ack)
         _sender.send_empty_segment();
@@ -105,6 +149,11 @@ size_t TCPConnection::write(const string &data) {
     return bytes_written;
 }
 
+void TCPConnection::flush() {
+    _sender.flush();
+    send_segment_with_ack_win();
+}
+
 //! \param[in] ms_since_last_tick number of milliseconds since the last call to this method
 void TCPConnection::tick(const size_t ms_since_last_tick) { 
 
@@ -147,6 +196,13 @@ void TCPConnection::tick(const size_t ms_since_last_tick) {
         return;
     }
 
+    // 被延迟的ACK等够了 delayed_ack_timeout 就发出去；如果本来就有段要发，它们会捎带ACK
+    if (_segments_unacked > 0) {
+        _ack_delay_elapsed += ms_since_last_tick;
+        if (_ack_delay_elapsed >= _cfg.delayed_ack_timeout && _sender.segments_out().empty())
+            _sender.send_empty_segment();
+    }
+
     // If we didn't hit the abort condition above
     send_segment_with_ack_win();
 
@@ -155,7 +211,7 @@ void TCPConnection::tick(const size_t ms_since_last_tick) {
     // End the connection cleanly
     const bool inbound_finished  = _receiver.stream_out().input_ended(); 
     const bool app_ended_out     = _sender.stream_in().eof();            
-    const bool all_acked         = _sender.bytes_in_flight() == 0;       
+    const bool all_acked         = TCPState::state_summary(_sender) == TCPSenderStateSummary::FIN_ACKED;
 
     if (inbound_finished && app_ended_out && all_acked) {
         if (!_linger_after_streams_finish) {
@@ -218,6 +274,23 @@ TCPConnection::~TCPConnection() {
     }
 }
 
+size_t TCPConnection::advertised_window(const bool syn) const {
+    const uint8_t shift = _window_scale_ok && !syn ? _rcv_window_scale : 0;
+    return min(static_cast<size_t>(numeric_limits<uint16_t>::max()), _receiver.window_size() >> shift) << shift;
+}
+
+void TCPConnection::update_window() {
+    if (!_active || !_receiver.ackno().has_value() || _receiver.stream_out().input_ended())
+        return;
+    // 接收方的糊涂窗口避免 (RFC 1122 4.2.3.3)：右沿至少前进 min(缓冲区一半, MSS) 才发窗口更新
+    const WrappingInt32 right_edge = _receiver.ackno().value() + advertised_window(false);
+    const size_t threshold = min(_cfg.recv_capacity / 2, _cfg.mss);
+    if (right_edge - _rcv_right_edge >= static_cast<int32_t>(threshold)) {
+        _sender.send_empty_segment();
+        send_segment_with_ack_win();
+    }
+}
+
 void TCPConnection::send_segment_with_ack_win(){
     // Send all the segments
     while (!_sender.segments_out().empty()) {
@@ -228,8 +301,32 @@ void TCPConnection::send_segment_with_ack_win(){
             segment.header().ack = true;
             segment.header().ackno = _receiver.ackno().value();
             // segment.header().win = _receiver.window_size();
+            // 任何带ACK的段都把被延迟的ACK一起确认了
+            _segments_unacked = 0;
+            _ack_delay_elapsed = 0;
         }
-        segment.header().win = min(static_cast<size_t>(numeric_limits<uint16_t>::max()), _receiver.window_size());
+        // 窗口缩放：SYN 段上的窗口不缩放；之后按协商的 shift 编码
+        const uint8_t shift = _window_scale_ok && !segment.header().syn ? _rcv_window_scale : 0;
+        const size_t window = advertised_window(segment.header().syn);
+        segment.header().win = window >> shift;
+        if (segment.header().ack)
+            _rcv_right_edge = segment.header().ackno + window;
+        // SYN 上通告我们愿意接收的最大段
+        if (segment.header().syn)
+            segment.header().mss = min(_cfg.mss, static_cast<size_t>(numeric_limits<uint16_t>::max()));
+        // 主动打开的 SYN 上提议；SYN/ACK 上只有对端提议了才回应
+        if (segment.header().syn && _cfg.window_scaling && (!segment.header().ack || _window_scale_ok))
+            segment.header().window_scale = _rcv_window_scale;
+        // SACK：和窗口缩放一样，主动打开的 SYN 上提议，SYN/ACK 上只有对端提议了才回应；协商成功后才报告乱序数据
+        segment.header().sack_permitted = segment.header().syn && _cfg.sack && (!segment.header().ack || _sack_ok);
+        if (_sack_ok && segment.header().ack)
+            segment.header().sack = _receiver.sack_blocks(MAX_SACK_BLOCKS);
+        // 时间戳：主动打开的 SYN 上提议；之后只有对端的 SYN 也带了才继续带，并回显 TS.Recent
+        if (_receiver.ts_recent().has_value() && segment.header().timestamps.has_value())
+            segment.header().timestamps->second = _receiver.ts_recent().value();
+        else if (!segment.header().syn || segment.header().ack)
+            segment.header().timestamps.reset();
+        segment.header().fit_doff();
         // 这里不需要专门设置 RST：若你要发送 RST，通常先让 sender 生成空段，再手动把 rst 位置 1
         _segments_out.push(move(segment));  // TCPConnection 对外的发送队列
     }
@@ -9,9 +9,12 @@
 //! \brief A complete endpoint of a TCP connection
 class TCPConnection {
   private:
+    //! Most SACK blocks that fit in the option space (RFC 2018, section 3)
+    static constexpr size_t MAX_SACK_BLOCKS = 4;
+
     TCPConfig _cfg;
-    TCPReceiver _receiver{_cfg.recv_capacity};
-    TCPSender _sender{_cfg.send_capacity, _cfg.rt_timeout, _cfg.fixed_isn};
+    TCPReceiver _receiver{_cfg.recv_capacity, _cfg.recv_storage, _cfg.reassembler, _cfg.timestamps};
+    TCPSender _sender{_cfg};
 
     //! outbound queue of segments that the TCPConnection wants sent
     std::queue<TCPSegment> _segments_out{};
@@ -25,6 +28,30 @@ class TCPConnection {
 
     bool _active{true};
 
+    //! Did both sides offer SACK on their SYNs?
+    bool _sack_ok{false};
+
+    //! Largest window scale shift allowed (RFC 7323, section 2.3)
+    static constexpr uint8_t MAX_WINDOW_SCALE = 14;
+
+    //! The shift we offer: the smallest that lets our window field describe all of recv_capacity
+    uint8_t _rcv_window_scale{0};
+
+    //! Did both sides offer window scaling on their SYNs?
+    bool _window_scale_ok{false};
+
+    //! In-order data segments received since we last sent an ACK (only counted under TCPConfig::delayed_ack)
+    size_t _segments_unacked{0};
+
+    //! Milliseconds the oldest of those segments has waited for its ACK
+    size_t _ack_delay_elapsed{0};
+
+    //! Right edge (ackno + window) of the last window we advertised
+    WrappingInt32 _rcv_right_edge{0};
+
+    //! The window we can advertise right now, rounded down to what the (scaled) window field can say
+    size_t advertised_window(const bool syn) const;
+
   public:
     //! \name "Input" interface for the writer
     //!@{
@@ -34,9 +61,13 @@ class TCPConnection {
     void connect();
 
     //! \brief Write data to the outbound byte stream, and send it over TCP if possible
+    //! \note Under TCPConfig::coalescing, a write too small to fill a segment may be held back
     //! \returns the number of bytes from `data` that were actually written.
     size_t write(const std::string &data);
 
+    //! \brief Send everything written so far, even if coalescing would hold it back
+    void flush();
+
     //! \returns the number of `bytes` that can be written right now.
     size_t remaining_outbound_capacity() const;
 
@@ -49,6 +80,11 @@ class TCPConnection {
 
     //! \brief The inbound byte stream received from the peer
     ByteStream &inbound_stream() { return _receiver.stream_out(); }
+
+    //! \brief Send a window update if reading from inbound_stream() has opened the window far enough
+    //! \details Call it after reading: a peer that filled the window (e.g. with one large segment) would
+    //! otherwise wait for its persist timer to learn that there is room again.
+    void update_window();
     //!@}
 
     //! \name Accessors used for testing
@@ -60,6 +96,8 @@ class TCPConnection {
     size_t unassembled_bytes() const;
     //! \brief Number of milliseconds since the last segment was received
     size_t time_since_last_segment_received() const;
+    //! \brief If pacing is holding segments back, the ms until tick() will release the next one
+    std::optional<size_t> pacing_delay() const { return _sender.pacing_delay(); }
     //!< \brief summarize the state of the sender, receiver, and the connection
     TCPState state() const { return {_sender, _receiver, active(), _linger_after_streams_finish}; };
     //!@}
@@ -86,7 +124,7 @@ class TCPConnection {
     //!@}
 
     //! Construct a new connection from a configuration
-    explicit TCPConnection(const TCPConfig &cfg) : _cfg{cfg} {}
+    explicit TCPConnection(const TCPConfig &cfg);
 
     //! \name construction and destruction
     //! moving is allowed; copying is disallowed; default construction not possible
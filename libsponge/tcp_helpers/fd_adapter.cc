@@ -6,6 +6,14 @@
 
 using namespace std;
 
+namespace {
+//! Largest UDP payload in an IPv4 datagram, and so the most a UDP GSO write can carry
+constexpr size_t MAX_UDP_PAYLOAD = 65507;
+
+//! Most datagrams the kernel will cut one UDP GSO write into (UDP_MAX_SEGMENTS on older kernels)
+constexpr size_t MAX_GSO_SEGMENTS = 64;
+}  // namespace
+
 //! \details This function first attempts to parse a TCP segment from the next UDP
 //! payload recv()d from the socket.
 //!
@@ -20,22 +28,43 @@ using namespace std;
 //! \returns a std::optional<TCPSegment> that is empty if the segment was invalid or unrelated
 optional<TCPSegment> TCPOverUDPSocketAdapter::read() {
     auto datagram = _sock.recv();
+    return unwrap_tcp_in_udp(datagram.source_address, move(datagram.payload));
+}
 
+//! \details Segments come out in the order their datagrams arrived, so a SYN that ends listening()
+//! filters the datagrams after it in the same batch. Each payload is copied out of its receive slot,
+//! which keeps the slots' storage for the next call.
+vector<TCPSegment> TCPOverUDPSocketAdapter::read_many() {
+    vector<TCPSegment> ret;
+    const size_t count = _sock.recv_many(_datagrams);
+    ret.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (auto seg = unwrap_tcp_in_udp(_datagrams.source_address(i), string{_datagrams.payload(i)})) {
+            ret.push_back(move(seg.value()));
+        }
+    }
+    return ret;
+}
+
+//! \param[in] source_address is where the datagram came from
+//! \param[in] payload is the datagram's payload, which is moved into the segment
+//! \returns a std::optional<TCPSegment> that is empty if the segment was invalid or unrelated
+optional<TCPSegment> TCPOverUDPSocketAdapter::unwrap_tcp_in_udp(const Address &source_address, string payload) {
     // is it for us?
-    if (not listening() and (datagram.source_address != config().destination)) {
+    if (not listening() and (source_address != config().destination)) {
         return {};
     }
 
     // is the payload a valid TCP segment?
     TCPSegment seg;
-    if (ParseResult::NoError != seg.parse(move(datagram.payload), 0)) {
+    if (ParseResult::NoError != seg.parse(move(payload), 0)) {
         return {};
     }
 
     // should we target this source in all future replies?
     if (listening()) {
         if (seg.header().syn and not seg.header().rst) {
-            config_mutable().destination = datagram.source_address;
+            config_mutable().destination = source_address;
             set_listening(false);
         } else {
             return {};
@@ -45,12 +74,49 @@ optional<TCPSegment> TCPOverUDPSocketAdapter::read() {
     return seg;
 }
 
-//! Serialize a TCP segment and send it as the payload of a UDP datagram.
-//! \param[in] seg is the TCP segment to write
-void TCPOverUDPSocketAdapter::write(TCPSegment &seg) {
+//! \param[in] seg is the TCP segment to serialize
+BufferList TCPOverUDPSocketAdapter::wrap_tcp_in_udp(TCPSegment &seg) {
     seg.header().sport = config().source.port();
     seg.header().dport = config().destination.port();
-    _sock.sendto(config().destination, seg.serialize(0));
+    return seg.serialize(0);
+}
+
+//! Serialize a TCP segment and send it as the payload of a UDP datagram.
+//! \param[in] seg is the TCP segment to write
+void TCPOverUDPSocketAdapter::write(TCPSegment &seg) { _sock.sendto(config().destination, wrap_tcp_in_udp(seg)); }
+
+//! \param[in,out] segments are the TCP segments to write, in order; the queue is left empty
+//! \details With FdAdapterConfig::udp_gso, every payload in a call holds whole segments of the first
+//! segment's size, perhaps followed by one shorter segment, which the kernel sends as separate datagrams.
+//! A segment longer than the first waits for the next call.
+void TCPOverUDPSocketAdapter::write_many(queue<TCPSegment> &segments) {
+    while (not segments.empty()) {
+        vector<BufferList> payloads;
+        size_t segment_size = 0;
+        while (not segments.empty() and payloads.size() < MAX_BATCH) {
+            BufferList wire = wrap_tcp_in_udp(segments.front());
+            if (config().udp_gso) {
+                if (segment_size == 0) {
+                    segment_size = wire.size();
+                }
+                if (wire.size() > segment_size) {
+                    break;
+                }
+                if (not payloads.empty()) {
+                    BufferList &last = payloads.back();
+                    if (last.size() % segment_size == 0 and last.size() + wire.size() <= MAX_UDP_PAYLOAD and
+                        last.size() / segment_size < MAX_GSO_SEGMENTS) {
+                        last.append(wire);
+                        segments.pop();
+                        continue;
+                    }
+                }
+            }
+            payloads.push_back(move(wire));
+            segments.pop();
+        }
+        _sock.sendto_many(config().destination, {payloads.begin(), payloads.end()}, segment_size);
+    }
 }
 
 //! Specialize LossyFdAdapter to TCPOverUDPSocketAdapter
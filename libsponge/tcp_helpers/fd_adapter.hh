@@ -9,7 +9,9 @@
 #include "tcp_segment.hh"
 
 #include <optional>
+#include <queue>
 #include <utility>
+#include <vector>
 
 //! \brief Basic functionality for file descriptor adaptors
 //! \details See TCPOverUDPSocketAdapter and TCPOverIPv4OverTunFdAdapter for more information.
@@ -43,20 +45,41 @@ class FdAdapterBase {
 };
 
 //! \brief A FD adaptor that reads and writes TCP segments in UDP payloads
+//! \details read_many() and write_many() pass up to MAX_BATCH datagrams per system call
+//! ([recvmmsg(2)](\ref man2::recvmmsg) and [sendmmsg(2)](\ref man2::sendmmsg)). With FdAdapterConfig::udp_gso,
+//! write_many() also packs runs of equal-sized segments into one UDP_SEGMENT payload for the kernel to cut up.
 class TCPOverUDPSocketAdapter : public FdAdapterBase {
   private:
     UDPSocket _sock;
 
+    //! Receive slots for read_many(), set up once and reused by every call
+    UDPSocket::received_batch _datagrams;
+
+    //! Checks that a UDP datagram carries a TCP segment related to the current connection, and parses it
+    std::optional<TCPSegment> unwrap_tcp_in_udp(const Address &source_address, std::string payload);
+
+    //! Sets the port numbers of a TCP segment and serializes it as a UDP payload
+    BufferList wrap_tcp_in_udp(TCPSegment &seg);
+
   public:
+    static constexpr size_t MAX_BATCH = 64;  //!< Most datagrams passed to or from the kernel in one call
+
     //! Construct from a UDPSocket sliced into a FileDescriptor
-    explicit TCPOverUDPSocketAdapter(UDPSocket &&sock) : _sock(std::move(sock)) {}
+    explicit TCPOverUDPSocketAdapter(UDPSocket &&sock)
+        : _sock(std::move(sock)), _datagrams(MAX_BATCH) {}
 
     //! Attempts to read and return a TCP segment related to the current connection from a UDP payload
     std::optional<TCPSegment> read();
 
+    //! Reads the datagrams already queued (at least one), and returns the TCP segments related to the connection
+    std::vector<TCPSegment> read_many();
+
     //! Writes a TCP segment into a UDP payload
     void write(TCPSegment &seg);
 
+    //! Writes and pops every queued TCP segment, each in its own UDP payload (or UDP GSO segment)
+    void write_many(std::queue<TCPSegment> &segments);
+
     //! Access the underlying UDP socket
     operator UDPSocket &() { return _sock; }
 
@@ -5,6 +5,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 using namespace std;
 
@@ -25,17 +26,20 @@ BufferList IPv4Datagram::serialize() const {
         throw runtime_error("IPv4Datagram::serialize: payload is wrong size");
     }
 
-    IPv4Header header_out = _header;
-    header_out.cksum = 0;
-    const string header_zero_checksum = header_out.serialize();
+    IPv4Header header_zero_checksum = _header;
+    header_zero_checksum.cksum = 0;
+    string header_out = header_zero_checksum.serialize();
 
-    // calculate checksum -- taken over header only
+    // calculate checksum -- taken over header only -- and patch it into the encoded header
     InternetChecksum check;
-    check.add(header_zero_checksum);
-    header_out.cksum = check.value();
+    check.add(header_out);
+    const uint16_t cksum = check.value();
+    constexpr size_t cksum_offset = 10;
+    header_out[cksum_offset] = char(cksum >> 8);
+    header_out[cksum_offset + 1] = char(cksum);
 
     BufferList ret;
-    ret.append(header_out.serialize());
+    ret.append(BufferList(move(header_out)));
     ret.append(_payload);
     return ret;
 }
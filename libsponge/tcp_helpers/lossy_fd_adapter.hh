@@ -7,8 +7,10 @@
 #include "util.hh"
 
 #include <optional>
+#include <queue>
 #include <random>
 #include <utility>
+#include <vector>
 
 //! An adapter class that adds random dropping behavior to an FD adapter
 template <typename AdapterT>
@@ -47,6 +49,18 @@ class LossyFdAdapter {
         return ret;
     }
 
+    //! \brief Read a batch from the underlying AdapterT instance, potentially dropping each datagram
+    //! \returns the segments that were not dropped
+    std::vector<TCPSegment> read_many() {
+        std::vector<TCPSegment> ret;
+        for (auto &seg : _adapter.read_many()) {
+            if (not _should_drop(false)) {
+                ret.push_back(std::move(seg));
+            }
+        }
+        return ret;
+    }
+
     //! \brief Write to the underlying AdapterT instance, potentially dropping the datagram to be written
     //! \param[in] seg is the packet to either write or drop
     void write(TCPSegment &seg) {
@@ -56,6 +70,18 @@ class LossyFdAdapter {
         return _adapter.write(seg);
     }
 
+    //! \brief Write a batch to the underlying AdapterT instance, potentially dropping each datagram
+    //! \param[in,out] segments are the packets to either write or drop; the queue is left empty
+    void write_many(std::queue<TCPSegment> &segments) {
+        std::queue<TCPSegment> kept;
+        for (; not segments.empty(); segments.pop()) {
+            if (not _should_drop(true)) {
+                kept.push(std::move(segments.front()));
+            }
+        }
+        _adapter.write_many(kept);
+    }
+
     //! \name
     //! Passthrough functions to the underlying AdapterT instance
 
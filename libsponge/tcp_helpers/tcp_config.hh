@@ -2,6 +2,9 @@
 #define SPONGE_LIBSPONGE_TCP_CONFIG_HH
 
 #include "address.hh"
+#include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "stream_reassembler.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -16,10 +19,36 @@ class TCPConfig {
     static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
     static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
 
+    //! How the sender treats data that does not fill a segment
+    enum class Coalescing {
+        None,   //!< send it at once (the default)
+        Nagle,  //!< hold it while earlier data is unacknowledged (RFC 896)
+        Cork    //!< hold it until a full segment builds up, or for at most `cork_timeout` ms (like TCP_CORK)
+    };
+
     uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
+    bool adaptive_rto = false;  //!< Arm the retransmission timer from measured RTTs (RFC 6298), not just rt_timeout
+    size_t rto_min = 200;       //!< Lower bound on the computed timeout, in ms (RFC 6298 says 1 s; Linux uses 200 ms)
+    size_t rto_max = 60000;     //!< Upper bound on the computed and backed-off timeout, in ms
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
+    ByteStream::Storage send_storage = ByteStream::Storage::Chunks;  //!< Chunks: payloads are slices of the buffer
+    ByteStream::Storage recv_storage = ByteStream::Storage::Ring;  //!< How the receiver buffers reassembled bytes
+    StreamReassembler::Mode reassembler = StreamReassembler::Mode::Map;  //!< How the receiver holds out-of-order bytes
     std::optional<WrappingInt32> fixed_isn{};
+    CongestionControl::Algorithm congestion_control = CongestionControl::Algorithm::None;  //!< Congestion window algorithm
+    bool fast_retransmit = false;  //!< Resend on the third duplicate ACK instead of waiting for the timer (RFC 5681)
+    bool sack = false;  //!< Offer selective acknowledgments (RFC 2018) on the SYN, and send them if the peer agrees
+    bool timestamps = false;  //!< Offer timestamps (RFC 7323) on the SYN: RTT samples from every ACK, and PAWS
+    bool window_scaling = false;  //!< Offer window scaling (RFC 7323) on the SYN, to advertise windows past 64 KiB
+    size_t mss = MAX_PAYLOAD_SIZE;  //!< Largest payload we send, and the MSS announced on our SYN (e.g. MTU - 40)
+    bool mtu_probing = false;       //!< Start at MAX_PAYLOAD_SIZE and probe up to the negotiated MSS (RFC 4821)
+    Coalescing coalescing = Coalescing::None;  //!< Small-write coalescing (TCPConnection::flush() overrides it)
+    size_t cork_timeout = 200;                 //!< Longest a partial segment waits under Coalescing::Cork, in ms
+    bool delayed_ack = false;  //!< ACK every second in-order data segment, or after a delay (RFC 1122, 4.2.3.2)
+    size_t delayed_ack_timeout = 40;  //!< Longest an ACK is delayed, in ms (RFC 1122 allows up to 500)
+    bool pacing = false;  //!< Spread new segments out at cwnd / SRTT x pacing_gain, released by tick()
+    double pacing_gain = 1.25;  //!< Pacing rate as a multiple of one window per RTT (above 1, so cwnd can grow)
 };
 
 //! Config for classes derived from FdAdapter
@@ -30,6 +59,8 @@ class FdAdapterConfig {
 
     uint16_t loss_rate_dn = 0;  //!< Downlink loss rate (for LossyFdAdapter)
     uint16_t loss_rate_up = 0;  //!< Uplink loss rate (for LossyFdAdapter)
+
+    bool udp_gso = false;  //!< Send runs of equal-sized segments as one UDP_SEGMENT write (TCPOverUDPSocketAdapter)
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_CONFIG_HH
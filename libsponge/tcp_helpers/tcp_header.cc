@@ -1,9 +1,24 @@
 #include "tcp_header.hh"
 
+#include <algorithm>
 #include <sstream>
 
 using namespace std;
 
+namespace {
+constexpr uint8_t OPT_EOL = 0;             //!< end of option list
+constexpr uint8_t OPT_NOP = 1;             //!< no-operation (padding)
+constexpr uint8_t OPT_MSS = 2;             //!< maximum segment size, RFC 9293
+constexpr uint8_t OPT_WINDOW_SCALE = 3;    //!< window scale shift count, RFC 7323
+constexpr uint8_t OPT_SACK_PERMITTED = 4;  //!< SACK-permitted, RFC 2018
+constexpr uint8_t OPT_SACK = 5;            //!< SACK blocks, RFC 2018
+constexpr uint8_t OPT_TIMESTAMPS = 8;      //!< TSval and TSecr, RFC 7323
+constexpr size_t TIMESTAMPS_LENGTH = 12;   //!< option bytes for timestamps, including the two leading NOPs
+
+//! Option bytes for SACK with `n` blocks, including the two leading NOPs
+size_t sack_length(const size_t n) { return n ? 4 + 8 * n : 0; }
+}  // namespace
+
 //! \param[in,out] p is a NetParser from which the TCP fields will be extracted
 //! \returns a ParseResult indicating success or the reason for failure
 //! \details It is important to check for (at least) the following potential errors
@@ -37,44 +52,174 @@ ParseResult TCPHeader::parse(NetParser &p) {
         return ParseResult::HeaderTooShort;
     }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
+    // parse the options we know; skip any others or anything extra in the header
+    const size_t options_len = doff * 4 - TCPHeader::LENGTH;
+    NetParser options{p.buffer()};
+    p.remove_prefix(options_len);
 
     if (p.error()) {
         return p.get_error();
     }
 
+    mss.reset();
+    sack_permitted = false;
+    sack.clear();
+    timestamps.reset();
+    window_scale.reset();
+    size_t pos = 0;
+    while (pos < options_len) {
+        const uint8_t kind = options.u8();
+        pos += 1;
+        if (kind == OPT_EOL) {
+            break;
+        }
+        if (kind == OPT_NOP) {
+            continue;
+        }
+        if (pos == options_len) {
+            break;
+        }
+        const uint8_t len = options.u8();
+        pos += 1;
+        if (len < 2 or pos + len - 2 > options_len) {
+            break;  // malformed; ignore the rest of the options
+        }
+        if (kind == OPT_MSS and len == 4) {
+            mss = options.u16();
+        } else if (kind == OPT_WINDOW_SCALE and len == 3) {
+            window_scale = options.u8();
+        } else if (kind == OPT_SACK_PERMITTED) {
+            sack_permitted = true;
+            options.remove_prefix(len - 2);
+        } else if (kind == OPT_SACK) {
+            for (size_t i = 0; i < size_t(len - 2) / 8; i++) {
+                const WrappingInt32 left{options.u32()};
+                sack.emplace_back(left, WrappingInt32{options.u32()});
+            }
+            options.remove_prefix((len - 2) % 8);
+        } else if (kind == OPT_TIMESTAMPS and len == 10) {
+            const uint32_t tsval = options.u32();
+            timestamps.emplace(tsval, options.u32());
+        } else {
+            options.remove_prefix(len - 2);
+        }
+        pos += len - 2;
+    }
+
     return ParseResult::NoError;
 }
 
-//! Serialize the TCPHeader to a string (does not recompute the checksum)
-string TCPHeader::serialize() const {
+size_t TCPHeader::options_length() const {
+    const size_t len = (mss.has_value() ? 4 : 0) + (sack_permitted ? 4 : 0) + (window_scale.has_value() ? 4 : 0) +
+                       (timestamps.has_value() ? TIMESTAMPS_LENGTH : 0) + sack_length(sack.size());
+    return (len + 3) / 4 * 4;
+}
+
+void TCPHeader::fit_doff() { doff = min(LENGTH + options_length(), MAX_LENGTH) / 4; }
+
+namespace {
+char *put_u8(char *p, const uint8_t val) {
+    *p = char(val);
+    return p + 1;
+}
+
+char *put_u16(char *p, const uint16_t val) {
+    p[0] = char(val >> 8);
+    p[1] = char(val);
+    return p + 2;
+}
+
+char *put_u32(char *p, const uint32_t val) {
+    p[0] = char(val >> 24);
+    p[1] = char(val >> 16);
+    p[2] = char(val >> 8);
+    p[3] = char(val);
+    return p + 4;
+}
+}  // namespace
+
+//! \param[out] out receives the header, 4 * `doff` bytes long (does not recompute the checksum)
+//! \returns the number of bytes written
+size_t TCPHeader::serialize(Encoded &out) const {
     // sanity check
     if (doff < 5) {
         throw runtime_error("TCP header too short");
     }
+    if (4 * size_t(doff) > MAX_LENGTH) {
+        throw runtime_error("TCP header too long");
+    }
 
-    string ret;
-    ret.reserve(4 * doff);
+    const size_t len = 4 * size_t(doff);
+    char *const begin = out.data();
+    char *p = begin;
+    const auto fits = [&](const size_t n) { return size_t(p - begin) + n <= len; };
 
-    NetUnparser::u16(ret, sport);              // source port
-    NetUnparser::u16(ret, dport);              // destination port
-    NetUnparser::u32(ret, seqno.raw_value());  // sequence number
-    NetUnparser::u32(ret, ackno.raw_value());  // ack number
-    NetUnparser::u8(ret, doff << 4);           // data offset
+    p = put_u16(p, sport);              // source port
+    p = put_u16(p, dport);              // destination port
+    p = put_u32(p, seqno.raw_value());  // sequence number
+    p = put_u32(p, ackno.raw_value());  // ack number
+    p = put_u8(p, doff << 4);           // data offset
 
     const uint8_t fl_b = (urg ? 0b0010'0000 : 0) | (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) |
                          (rst ? 0b0000'0100 : 0) | (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);
-    NetUnparser::u8(ret, fl_b);  // flags
-    NetUnparser::u16(ret, win);  // window size
+    p = put_u8(p, fl_b);  // flags
+    p = put_u16(p, win);  // window size
 
-    NetUnparser::u16(ret, cksum);  // checksum
+    p = put_u16(p, cksum);  // checksum
 
-    NetUnparser::u16(ret, uptr);  // urgent pointer
+    p = put_u16(p, uptr);  // urgent pointer
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    // options, each only if it fits in the advertised size
+    if (mss.has_value() and fits(4)) {
+        p = put_u8(p, OPT_MSS);
+        p = put_u8(p, 4);
+        p = put_u16(p, mss.value());
+    }
+    if (sack_permitted and fits(4)) {
+        p = put_u8(p, OPT_NOP);
+        p = put_u8(p, OPT_NOP);
+        p = put_u8(p, OPT_SACK_PERMITTED);
+        p = put_u8(p, 2);
+    }
+    if (window_scale.has_value() and fits(4)) {
+        p = put_u8(p, OPT_NOP);
+        p = put_u8(p, OPT_WINDOW_SCALE);
+        p = put_u8(p, 3);
+        p = put_u8(p, window_scale.value());
+    }
+    // timestamps go before SACK blocks, which are cut down to whatever room is left
+    if (timestamps.has_value() and fits(TIMESTAMPS_LENGTH)) {
+        p = put_u8(p, OPT_NOP);
+        p = put_u8(p, OPT_NOP);
+        p = put_u8(p, OPT_TIMESTAMPS);
+        p = put_u8(p, 10);
+        p = put_u32(p, timestamps->first);
+        p = put_u32(p, timestamps->second);
+    }
+    size_t sack_blocks = sack.size();
+    while (sack_blocks > 0 and not fits(sack_length(sack_blocks))) {
+        sack_blocks--;
+    }
+    if (sack_blocks > 0) {
+        p = put_u8(p, OPT_NOP);
+        p = put_u8(p, OPT_NOP);
+        p = put_u8(p, OPT_SACK);
+        p = put_u8(p, 2 + 8 * sack_blocks);
+        for (size_t i = 0; i < sack_blocks; i++) {
+            p = put_u32(p, sack[i].first.raw_value());
+            p = put_u32(p, sack[i].second.raw_value());
+        }
+    }
+
+    fill(p, begin + len, char(OPT_EOL));  // pad the header to its advertised size
 
-    return ret;
+    return len;
+}
+
+//! Serialize the TCPHeader to a string (does not recompute the checksum)
+string TCPHeader::serialize() const {
+    Encoded out;
+    return string(out.data(), serialize(out));
 }
 
 //! \returns A string with the header's contents
@@ -89,14 +234,40 @@ string TCPHeader::to_string() const {
        << " fin: " << fin << '\n'
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
-       << "TCP uptr: " << +uptr << '\n';
+       << "TCP uptr: " << +uptr << '\n'
+       << "TCP sack_permitted: " << sack_permitted << '\n';
+    if (mss.has_value()) {
+        ss << dec << "TCP mss: " << mss.value() << '\n' << hex;
+    }
+    if (window_scale.has_value()) {
+        ss << dec << "TCP window scale: " << +window_scale.value() << '\n' << hex;
+    }
+    if (timestamps.has_value()) {
+        ss << dec << "TCP timestamps: TSval " << timestamps->first << " TSecr " << timestamps->second << '\n' << hex;
+    }
+    for (const auto &[left, right] : sack) {
+        ss << "TCP sack block: " << left << " - " << right << '\n';
+    }
     return ss.str();
 }
 
 string TCPHeader::summary() const {
     stringstream ss{};
     ss << "Header(flags=" << (syn ? "S" : "") << (ack ? "A" : "") << (rst ? "R" : "") << (fin ? "F" : "")
-       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win << ")";
+       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win;
+    for (const auto &[left, right] : sack) {
+        ss << ",sack=" << left << "-" << right;
+    }
+    if (mss.has_value()) {
+        ss << ",mss=" << mss.value();
+    }
+    if (window_scale.has_value()) {
+        ss << ",wscale=" << +window_scale.value();
+    }
+    if (timestamps.has_value()) {
+        ss << ",ts=" << timestamps->first << "/" << timestamps->second;
+    }
+    ss << ")";
     return ss.str();
 }
 
@@ -5,10 +5,21 @@
 // #include "parser.hh"
 #include "wrapping_integers.hh"
 
+#include <array>
+#include <optional>
+#include <utility>
+#include <vector>
+
 //! \brief [TCP](\ref rfc::rfc793) segment header
-//! \note TCP options are not supported
+//! \note Options are parsed and serialized only if listed below; others are skipped.
+//! Options are only serialized if they fit within `doff` (see fit_doff()).
 struct TCPHeader {
-    static constexpr size_t LENGTH = 20;  //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t LENGTH = 20;           //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t MAX_LENGTH = 60;       //!< largest header `doff` can describe
+    static constexpr size_t CHECKSUM_OFFSET = 16;  //!< where the checksum field starts
+
+    //! A serialized header, built on the stack
+    using Encoded = std::array<char, MAX_LENGTH>;
 
     //! \struct TCPHeader
     //! ~~~{.txt}
@@ -51,12 +62,30 @@ struct TCPHeader {
     uint16_t uptr = 0;          //!< urgent pointer
     //!@}
 
+    //! \name TCP options
+    //!@{
+    std::optional<uint16_t> mss{};                               //!< maximum segment size (RFC 9293), on SYNs
+    bool sack_permitted = false;                                 //!< SACK-permitted (RFC 2018)
+    std::vector<std::pair<WrappingInt32, WrappingInt32>> sack{};  //!< SACK blocks, as (left edge, right edge)
+    std::optional<std::pair<uint32_t, uint32_t>> timestamps{};   //!< timestamps (RFC 7323), as (TSval, TSecr)
+    std::optional<uint8_t> window_scale{};                       //!< window scale shift count (RFC 7323), on SYNs
+    //!@}
+
+    //! Number of bytes the options need, padded to a multiple of four
+    size_t options_length() const;
+
+    //! Set `doff` so that the header has room for all of its options
+    void fit_doff();
+
     //! Parse the TCP fields from the provided NetParser
     ParseResult parse(NetParser &p);
 
     //! Serialize the TCP fields
     std::string serialize() const;
 
+    //! Serialize the TCP fields into `out`, without allocating
+    size_t serialize(Encoded &out) const;
+
     //! Return a string containing a header in human-readable format
     std::string to_string() const;
 
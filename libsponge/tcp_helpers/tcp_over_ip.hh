@@ -11,9 +11,9 @@
 //! \brief A converter from TCP segments to serialized IPv4 datagrams
 class TCPOverIPv4Adapter : public FdAdapterBase {
   public:
-    std::optional<TCPSegment> unwrap_tcp_in_ip(const InternetDatagram &ip_dgram);
+    std::optional<TCPSegment> unwrap_tcp_in_ip(const InternetDatagram &ip_dgram, const bool checksum_trusted = false);
 
-    InternetDatagram wrap_tcp_in_ip(TCPSegment &seg);
+    InternetDatagram wrap_tcp_in_ip(TCPSegment &seg, const bool partial_checksum = false);
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_OVER_IP_HH
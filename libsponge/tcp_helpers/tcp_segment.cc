@@ -10,11 +10,16 @@ using namespace std;
 
 //! \param[in] buffer string/Buffer to be parsed
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
-ParseResult TCPSegment::parse(const Buffer buffer, const uint32_t datagram_layer_checksum) {
-    InternetChecksum check(datagram_layer_checksum);
-    check.add(buffer);
-    if (check.value()) {
-        return ParseResult::BadChecksum;
+//! \param[in] checksum_trusted is `true` if the checksum need not be verified
+ParseResult TCPSegment::parse(const Buffer buffer,
+                              const uint32_t datagram_layer_checksum,
+                              const bool checksum_trusted) {
+    if (not checksum_trusted) {
+        InternetChecksum check(datagram_layer_checksum);
+        check.add(buffer);
+        if (check.value()) {
+            return ParseResult::BadChecksum;
+        }
     }
 
     NetParser p{buffer};
@@ -28,18 +33,33 @@ size_t TCPSegment::length_in_sequence_space() const {
 }
 
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
-BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
-    TCPHeader header_out = _header;
-    header_out.cksum = 0;
+//! \param[in] partial_checksum is `true` to store only the folded pseudo-checksum, uninverted, and leave
+//! summing the segment to whoever completes the checksum (CHECKSUM_PARTIAL in Linux terms)
+//! \details The header is encoded once, on the stack; the checksum is computed over those bytes
+//! (with the checksum field zeroed) and the payload, then stored into the checksum field. A payload
+//! whose sum was taken when it was copied (Buffer::partial_checksum) is not read again.
+BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum, const bool partial_checksum) const {
+    TCPHeader::Encoded header_out;
+    const size_t header_len = _header.serialize(header_out);
+    constexpr size_t cksum_offset = TCPHeader::CHECKSUM_OFFSET;
+    header_out[cksum_offset] = header_out[cksum_offset + 1] = 0;
 
     // calculate checksum -- taken over entire segment
     InternetChecksum check(datagram_layer_checksum);
-    check.add(header_out.serialize());
-    check.add(_payload);
-    header_out.cksum = check.value();
+    if (not partial_checksum) {
+        check.add({header_out.data(), header_len});
+        if (const auto payload_sum = _payload.partial_checksum()) {
+            check.add_sum(*payload_sum, _payload.size());
+        } else {
+            check.add(_payload);
+        }
+    }
+    const uint16_t cksum = partial_checksum ? check.sum() : check.value();
+    header_out[cksum_offset] = char(cksum >> 8);
+    header_out[cksum_offset + 1] = char(cksum);
 
     BufferList ret;
-    ret.append(header_out.serialize());
+    ret.append(BufferList(string(header_out.data(), header_len)));
     ret.append(_payload);
 
     return ret;
@@ -14,10 +14,15 @@ class TCPSegment {
 
   public:
     //! \brief Parse the segment from a string
-    ParseResult parse(const Buffer buffer, const uint32_t datagram_layer_checksum = 0);
+    //! \param[in] checksum_trusted skips verifying the checksum, which a lower layer has already done
+    ParseResult parse(const Buffer buffer,
+                      const uint32_t datagram_layer_checksum = 0,
+                      const bool checksum_trusted = false);
 
     //! \brief Serialize the segment to a string
-    BufferList serialize(const uint32_t datagram_layer_checksum = 0) const;
+    //! \param[in] partial_checksum leaves only the pseudo-header sum in the checksum field, for the kernel
+    //! (or a NIC) to complete
+    BufferList serialize(const uint32_t datagram_layer_checksum = 0, const bool partial_checksum = false) const;
 
     //! \name Accessors
     //!@{
@@ -5,6 +5,7 @@
 #include "tun.hh"
 #include "util.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -25,7 +26,9 @@ template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
     auto base_time = timestamp_ms();
     while (condition()) {
-        auto ret = _eventloop.wait_next_event(TCP_TICK_MS);
+        // wake up early if pacing is waiting for time to pass
+        const auto pacing_delay = _tcp.has_value() ? _tcp.value().pacing_delay() : nullopt;
+        auto ret = _eventloop.wait_next_event(static_cast<int>(min(TCP_TICK_MS, pacing_delay.value_or(TCP_TICK_MS))));
         if (ret == EventLoop::Result::Exit or _abort) {
             break;
         }
@@ -58,7 +61,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
 
     // There are four possible events to handle:
     //
-    // 1) Incoming datagram received (needs to be given to
+    // 1) Incoming datagrams received (need to be given to
     //    TCPConnection::segment_received method)
     //
     // 2) Outbound bytes received from local application via a write()
@@ -69,16 +72,15 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
     //    (needs to be read from the inbound_stream and written
     //    to the local stream socket back to the application)
     //
-    // 4) Outbound segment generated by TCP (needs to be
-    //    given to underlying datagram socket)
+    // 4) Outbound segments generated by TCP (need to be
+    //    given to underlying datagram socket, as a batch)
 
     // rule 1: read from filtered packet stream and dump into TCPConnection
     _eventloop.add_rule(_datagram_adapter,
                         Direction::In,
                         [&] {
-                            auto seg = _datagram_adapter.read();
-                            if (seg) {
-                                _tcp->segment_received(move(seg.value()));
+                            for (auto &seg : _datagram_adapter.read_many()) {
+                                _tcp->segment_received(move(seg));
                             }
 
                             // debugging output:
@@ -129,9 +131,9 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
             // the pipe, handling the possibility of a partial
             // write (i.e., only pop what was actually written).
             const size_t amount_to_write = min(size_t(65536), inbound.buffer_size());
-            const std::string buffer = inbound.peek_output(amount_to_write);
-            const auto bytes_written = _thread_data.write(move(buffer), false);
+            const auto bytes_written = _thread_data.write(inbound.peek_output_views(amount_to_write), false);
             inbound.pop_output(bytes_written);
+            _tcp->update_window();
 
             if (inbound.eof() or inbound.error()) {
                 _thread_data.shutdown(SHUT_WR);
@@ -153,12 +155,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
     // rule 4: read outbound segments from TCPConnection and send as datagrams
     _eventloop.add_rule(_datagram_adapter,
                         Direction::Out,
-                        [&] {
-                            while (not _tcp->segments_out().empty()) {
-                                _datagram_adapter.write(_tcp->segments_out().front());
-                                _tcp->segments_out().pop();
-                            }
-                        },
+                        [&] { _datagram_adapter.write_many(_tcp->segments_out()); },
                         [&] { return not _tcp->segments_out().empty(); });
 }
 
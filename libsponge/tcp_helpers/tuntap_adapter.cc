@@ -1,7 +1,122 @@
 #include "tuntap_adapter.hh"
 
+#include "parser.hh"
+#include "virtio_net_header.hh"
+
+#include <vector>
+
 using namespace std;
 
+namespace {
+//! The longest IPv4 datagram, and so the longest super-segment (with its IP and TCP headers)
+constexpr size_t MAX_SUPER_SEGMENT_LENGTH = 65535;
+
+//! A virtio-net header asking the kernel to finish the checksum of a TCP segment that starts
+//! `tcp_start` bytes into the packet
+VirtioNetHeader partial_checksum_header(const size_t tcp_start) {
+    VirtioNetHeader vnet;
+    vnet.flags = VirtioNetHeader::FLAG_NEEDS_CSUM;
+    vnet.csum_start = tcp_start;
+    vnet.csum_offset = TCPHeader::CHECKSUM_OFFSET;
+    return vnet;
+}
+
+//! \returns `true` if `next` can follow `last` in a super-segment whose segments carry `gso_size` bytes:
+//! `last` is full, `next` picks up where it ends, and the header the kernel will copy onto every piece
+//! is the same for both (apart from the seqno, and a FIN, which the kernel leaves on the last piece)
+bool continues_run(const TCPSegment &last, const TCPSegment &next, const size_t gso_size) {
+    const TCPHeader &prev = last.header();
+    if (last.payload().size() != gso_size or prev.syn or prev.fin or prev.rst) {
+        return false;
+    }
+    if (next.payload().size() == 0 or next.payload().size() > gso_size or
+        next.header().seqno != prev.seqno + last.length_in_sequence_space()) {
+        return false;
+    }
+    TCPHeader header = next.header();
+    header.seqno = prev.seqno;
+    header.fin = false;
+    return header == prev and header.sack == prev.sack and header.timestamps == prev.timestamps;
+}
+}  // namespace
+
+optional<TCPSegment> TCPOverIPv4OverTunFdAdapter::read() {
+    NetParser p{_tun.read()};
+    VirtioNetHeader vnet;
+    if (_tun.vnet_hdr() and vnet.parse(p) != ParseResult::NoError) {
+        return {};
+    }
+    InternetDatagram ip_dgram;
+    if (ip_dgram.parse(p.buffer()) != ParseResult::NoError) {
+        return {};
+    }
+    return unwrap_tcp_in_ip(ip_dgram, vnet.checksum_trusted());
+}
+
+vector<TCPSegment> TCPOverIPv4OverTunFdAdapter::read_many() {
+    vector<TCPSegment> ret;
+    if (auto seg = read()) {
+        ret.push_back(move(seg.value()));
+    }
+    return ret;
+}
+
+//! \param[in] seg the TCPSegment to send
+void TCPOverIPv4OverTunFdAdapter::write(TCPSegment &seg) {
+    if (not _tun.vnet_hdr()) {
+        _tun.write(wrap_tcp_in_ip(seg).serialize());
+        return;
+    }
+    const InternetDatagram ip_dgram = wrap_tcp_in_ip(seg, true);
+    BufferList packet{partial_checksum_header(4 * ip_dgram.header().hlen).serialize()};
+    packet.append(ip_dgram.serialize());
+    _tun.write(packet);
+}
+
+//! \param[in,out] segments are the TCP segments to write, in order; the queue is left empty
+//! \details Without a virtio-net header, each segment is written on its own. With one, every run of
+//! back-to-back full-sized segments (as TCPSender cuts them from a window) goes to the kernel as a single
+//! TCP super-segment of up to 64 KiB, with a GSO_TCPV4 header telling the kernel where to cut it again.
+void TCPOverIPv4OverTunFdAdapter::write_many(queue<TCPSegment> &segments) {
+    while (not segments.empty()) {
+        vector<TCPSegment> run;
+        run.push_back(move(segments.front()));
+        segments.pop();
+        const size_t gso_size = run.front().payload().size();
+        size_t length = IPv4Header::LENGTH + 4 * run.front().header().doff + gso_size;
+        while (_tun.vnet_hdr() and not segments.empty() and continues_run(run.back(), segments.front(), gso_size) and
+               length + segments.front().payload().size() <= MAX_SUPER_SEGMENT_LENGTH) {
+            length += segments.front().payload().size();
+            run.push_back(move(segments.front()));
+            segments.pop();
+        }
+        if (run.size() == 1) {
+            write(run.front());
+            continue;
+        }
+
+        // the first segment's header (with the last one's FIN), followed by every payload, uncopied
+        TCPSegment head;
+        head.header() = run.front().header();
+        head.header().fin = run.back().header().fin;
+        InternetDatagram ip_dgram = wrap_tcp_in_ip(head, true);
+        ip_dgram.header().len = length;
+        // serialize the TCP header again, now that the pseudo-header sum covers the whole super-segment
+        ip_dgram.payload() = head.serialize(ip_dgram.header().pseudo_cksum(), true);
+        for (const TCPSegment &seg : run) {
+            ip_dgram.payload().append(seg.payload());
+        }
+
+        VirtioNetHeader vnet = partial_checksum_header(4 * ip_dgram.header().hlen);
+        vnet.gso_type = VirtioNetHeader::GSO_TCPV4;
+        vnet.gso_size = gso_size;
+        vnet.hdr_len = 4 * ip_dgram.header().hlen + 4 * head.header().doff;
+        BufferList packet{vnet.serialize()};
+        packet.append(ip_dgram.serialize());
+        _tun.write(packet);
+    }
+}
+
 //! \param[in] tap Raw network device that will be owned by the adapter
 //! \param[in] eth_address Ethernet address (local address) of the adapter
 //! \param[in] ip_address IP address (local address) of the adapter
@@ -13,13 +128,20 @@ TCPOverIPv4OverEthernetAdapter::TCPOverIPv4OverEthernetAdapter(TapFD &&tap,
     : _tap(move(tap)), _interface(eth_address, ip_address), _next_hop(next_hop) {
     // Linux seems to ignore the first frame sent on a TAP device, so send a dummy frame to prime the pump :-(
     EthernetFrame dummy_frame;
-    _tap.write(dummy_frame.serialize());
+    BufferList packet{_tap.vnet_hdr() ? VirtioNetHeader{}.serialize() : string{}};
+    packet.append(dummy_frame.serialize());
+    _tap.write(packet);
 }
 
 optional<TCPSegment> TCPOverIPv4OverEthernetAdapter::read() {
-    // Read Ethernet frame from the raw device
+    // Read Ethernet frame (after its virtio-net header, if there is one) from the raw device
+    NetParser p{_tap.read()};
+    VirtioNetHeader vnet;
+    if (_tap.vnet_hdr() and vnet.parse(p) != ParseResult::NoError) {
+        return {};
+    }
     EthernetFrame frame;
-    if (frame.parse(_tap.read()) != ParseResult::NoError) {
+    if (frame.parse(p.buffer()) != ParseResult::NoError) {
         return {};
     }
 
@@ -31,11 +153,19 @@ optional<TCPSegment> TCPOverIPv4OverEthernetAdapter::read() {
 
     // Try to interpret IPv4 datagram as TCP
     if (ip_dgram) {
-        return unwrap_tcp_in_ip(ip_dgram.value());
+        return unwrap_tcp_in_ip(ip_dgram.value(), vnet.checksum_trusted());
     }
     return {};
 }
 
+vector<TCPSegment> TCPOverIPv4OverEthernetAdapter::read_many() {
+    vector<TCPSegment> ret;
+    if (auto seg = read()) {
+        ret.push_back(move(seg.value()));
+    }
+    return ret;
+}
+
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPOverIPv4OverEthernetAdapter::tick(const size_t ms_since_last_tick) {
     _interface.tick(ms_since_last_tick);
@@ -44,13 +174,35 @@ void TCPOverIPv4OverEthernetAdapter::tick(const size_t ms_since_last_tick) {
 
 //! \param[in] seg the TCPSegment to send
 void TCPOverIPv4OverEthernetAdapter::write(TCPSegment &seg) {
-    _interface.send_datagram(wrap_tcp_in_ip(seg), _next_hop);
+    _interface.send_datagram(wrap_tcp_in_ip(seg, _tap.vnet_hdr()), _next_hop);
     send_pending();
 }
 
+//! \param[in,out] segments are the TCP segments to send, in order; the queue is left empty
+void TCPOverIPv4OverEthernetAdapter::write_many(queue<TCPSegment> &segments) {
+    while (not segments.empty()) {
+        write(segments.front());
+        segments.pop();
+    }
+}
+
+//! \details With a virtio-net header, every IPv4 frame carries a TCP segment from write(), whose checksum
+//! was left partial; ARP frames need nothing from the kernel.
 void TCPOverIPv4OverEthernetAdapter::send_pending() {
     while (not _interface.frames_out().empty()) {
-        _tap.write(_interface.frames_out().front().serialize());
+        const EthernetFrame &frame = _interface.frames_out().front();
+        if (not _tap.vnet_hdr()) {
+            _tap.write(frame.serialize());
+        } else {
+            VirtioNetHeader vnet;
+            if (frame.header().type == EthernetHeader::TYPE_IPv4) {
+                const size_t ip_header_length = 4 * (frame.payload().buffers().front().at(0) & 0x0f);
+                vnet = partial_checksum_header(EthernetHeader::LENGTH + ip_header_length);
+            }
+            BufferList packet{vnet.serialize()};
+            packet.append(frame.serialize());
+            _tap.write(packet);
+        }
         _interface.frames_out().pop();
     }
 }
@@ -6,10 +6,17 @@
 #include "tun.hh"
 
 #include <optional>
+#include <queue>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 //! \brief A FD adapter for IPv4 datagrams read from and written to a TUN device
+//! \details If the TunFD was opened with a virtio-net header (TunTapFD::vnet_hdr()), TCP checksums are
+//! offloaded: outgoing segments carry only the pseudo-header sum for the kernel to complete, and incoming
+//! segments whose checksum the kernel has verified (or will complete) are not checked again. Runs of
+//! back-to-back segments are also handed to the kernel as one super-segment of up to 64 KiB for it to cut
+//! up again (TCP segmentation offload), and the kernel may hand over super-segments it has not cut up.
 class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
   private:
     TunFD _tun;
@@ -19,16 +26,16 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
     explicit TCPOverIPv4OverTunFdAdapter(TunFD &&tun) : _tun(std::move(tun)) {}
 
     //! Attempts to read and parse an IPv4 datagram containing a TCP segment related to the current connection
-    std::optional<TCPSegment> read() {
-        InternetDatagram ip_dgram;
-        if (ip_dgram.parse(_tun.read()) != ParseResult::NoError) {
-            return {};
-        }
-        return unwrap_tcp_in_ip(ip_dgram);
-    }
+    std::optional<TCPSegment> read();
+
+    //! Reads one IPv4 datagram, as read() does (a TUN device returns one packet per read, perhaps a super-segment)
+    std::vector<TCPSegment> read_many();
 
     //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
-    void write(TCPSegment &seg) { _tun.write(wrap_tcp_in_ip(seg).serialize()); }
+    void write(TCPSegment &seg);
+
+    //! Writes and pops every queued TCP segment, coalescing runs of them into super-segments if it can
+    void write_many(std::queue<TCPSegment> &segments);
 
     //! Access the underlying TUN device
     operator TunFD &() { return _tun; }
@@ -41,6 +48,7 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
 using LossyTCPOverIPv4OverTunFdAdapter = LossyFdAdapter<TCPOverIPv4OverTunFdAdapter>;
 
 //! \brief A FD adapter for IPv4 datagrams read from and written to a TAP device
+//! \details Offloads TCP checksums like TCPOverIPv4OverTunFdAdapter when the TapFD has a virtio-net header.
 class TCPOverIPv4OverEthernetAdapter : public TCPOverIPv4Adapter {
   private:
     TapFD _tap;  //!< Raw Ethernet connection
@@ -60,9 +68,15 @@ class TCPOverIPv4OverEthernetAdapter : public TCPOverIPv4Adapter {
     //! Attempts to read and parse an Ethernet frame containing an IPv4 datagram that contains a TCP segment
     std::optional<TCPSegment> read();
 
+    //! Reads one Ethernet frame, as read() does
+    std::vector<TCPSegment> read_many();
+
     //! Sends a TCP segment (in an IPv4 datagram, in an Ethernet frame).
     void write(TCPSegment &seg);
 
+    //! Sends and pops every queued TCP segment
+    void write_many(std::queue<TCPSegment> &segments);
+
     //! Called periodically when time elapses
     void tick(const size_t ms_since_last_tick);
 
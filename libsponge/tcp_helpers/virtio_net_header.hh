@@ -0,0 +1,46 @@
+#ifndef SPONGE_LIBSPONGE_VIRTIO_NET_HEADER_HH
+#define SPONGE_LIBSPONGE_VIRTIO_NET_HEADER_HH
+
+#include "parser.hh"
+
+#include <cstdint>
+#include <string>
+
+//! \brief The virtio-net header that precedes every packet on a TUN/TAP device opened with IFF_VNET_HDR
+//! \details It tells the kernel (on write) or the reader (on read) what is left to do to the packet's checksum.
+//! TunTapFD puts the device in little-endian mode, so the multi-byte fields are little-endian on every host.
+struct VirtioNetHeader {
+    static constexpr size_t LENGTH = 10;  //!< virtio-net header length in bytes (without the mergeable-buffer count)
+
+    //! The checksum at `csum_start + csum_offset` holds only the pseudo-header sum; the rest of the packet
+    //! from `csum_start` on still has to be added in (and the result inverted)
+    static constexpr uint8_t FLAG_NEEDS_CSUM = 1;
+    static constexpr uint8_t FLAG_DATA_VALID = 2;  //!< The checksum has already been verified
+    static constexpr uint8_t GSO_NONE = 0;         //!< Not a segmentation-offload packet
+    static constexpr uint8_t GSO_TCPV4 = 1;        //!< An IPv4 TCP super-segment, to be cut into `gso_size` payloads
+
+    //! \name virtio-net header fields
+    //!@{
+    uint8_t flags = 0;
+    uint8_t gso_type = GSO_NONE;
+    uint16_t hdr_len = 0;      //!< length of the headers repeated in front of every segment (GSO only)
+    uint16_t gso_size = 0;     //!< payload length of every segment but the last (GSO only)
+    uint16_t csum_start = 0;   //!< where the checksummed part starts (bytes from the end of this header)
+    uint16_t csum_offset = 0;  //!< where the checksum field is (bytes from `csum_start`)
+    //!@}
+
+    //! Parse the virtio-net fields from the provided NetParser
+    ParseResult parse(NetParser &p);
+
+    //! Serialize the virtio-net fields to a string
+    std::string serialize() const;
+
+    //! \returns `true` if the kernel has checked the checksum, or will complete it (so there is nothing to verify)
+    bool checksum_trusted() const { return flags & (FLAG_NEEDS_CSUM | FLAG_DATA_VALID); }
+};
+
+//! \struct VirtioNetHeader
+//! See the virtio specification, section 5.1.6 ("Device Operation"), and
+//! [the kernel's TUN/TAP documentation](https://www.kernel.org/doc/Documentation/networking/tuntap.txt).
+
+#endif  // SPONGE_LIBSPONGE_VIRTIO_NET_HEADER_HH
@@ -10,12 +10,23 @@ void DUMMY_CODE(Targs &&... /* unused */) {}
 
 using namespace std;
 
-void TCPReceiver::segment_received(const TCPSegment &seg) {
+bool TCPReceiver::segment_received(const TCPSegment &seg) {
     const TCPHeader &header = seg.header();
     if (!_syn_seen) {
-        if (!header.syn) return;
+        if (!header.syn) return true;
         _syn_seen = true;
         _isn = header.seqno; // 记录初始序号(32-bit)
+        // 双方的SYN都带时间戳才启用（RFC 7323 协商）
+        if (_timestamps && header.timestamps.has_value())
+            _ts_recent = header.timestamps->first;
+    } else if (_ts_recent.has_value() && header.timestamps.has_value() && !header.rst) {
+        const uint32_t tsval = header.timestamps->first;
+        // PAWS：时间戳比 TS.Recent 旧（按32位回绕比较），是序号回绕前的旧重复段，丢弃
+        if (static_cast<int32_t>(tsval - _ts_recent.value()) < 0)
+            return false;
+        // 只有不超前于当前 ackno 的段才更新 TS.Recent，这样回显的是最早未确认段的时间
+        if (header.seqno - ackno().value() <= 0)
+            _ts_recent = tsval;
     }
     // 2) 计算 checkpoint（绝对序号坐标系下“附近”的参考点）
     //    = 已经写入到ByteStream的字节数 + 1(因为SYN占一个序号格)
@@ -31,8 +42,9 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
     const uint64_t steam_index = header_abs + (header.syn ? 1 : 0) - 1;
 
     // 5) 取出payload，投喂 Reassembler。若带FIN，告诉reassembler这是最后位置。
-    const string payload = seg.payload().copy();
-    _reassembler.push_substring(payload, steam_index, header.fin);
+    //    直接传 Buffer，按序到达时不必复制 payload
+    _reassembler.push_substring(seg.payload(), steam_index, header.fin);
+    return true;
 }
 
 optional<WrappingInt32> TCPReceiver::ackno() const { 
@@ -49,4 +61,14 @@ optional<WrappingInt32> TCPReceiver::ackno() const {
     return wrap(abs_ack, _isn);
  }
 
+vector<pair<WrappingInt32, WrappingInt32>> TCPReceiver::sack_blocks(const size_t max_blocks) const {
+    vector<pair<WrappingInt32, WrappingInt32>> blocks;
+    if (!_syn_seen) return blocks;
+    // stream index -> absolute seqno is +1 (SYN占位)
+    for (const auto &[begin, end] : _reassembler.held_ranges(max_blocks)) {
+        blocks.emplace_back(wrap(begin + 1, _isn), wrap(end + 1, _isn));
+    }
+    return blocks;
+}
+
 size_t TCPReceiver::window_size() const { return _capacity - _reassembler.stream_out().buffer_size(); }
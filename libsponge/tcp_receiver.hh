@@ -7,6 +7,8 @@
 #include "wrapping_integers.hh"
 
 #include <optional>
+#include <utility>
+#include <vector>
 
 //! \brief The "receiver" part of a TCP implementation.
 
@@ -22,16 +24,27 @@ class TCPReceiver {
     //! 
     bool _syn_seen;
     WrappingInt32 _isn;
+    //! Did we offer timestamps (TCPConfig::timestamps)?
+    bool _timestamps;
+    //! TS.Recent (RFC 7323): the TSval to echo; empty unless both SYNs carried timestamps
+    std::optional<uint32_t> _ts_recent{};
   public:
     //! \brief Construct a TCP receiver
     //!
     //! \param capacity the maximum number of bytes that the receiver will
     //!                 store in its buffers at any give time.
-    TCPReceiver(const size_t capacity) : 
-    _reassembler(capacity), 
+    //! \param storage how the reassembled bytes are held (see ByteStream::Storage)
+    //! \param mode how out-of-order bytes are held (see StreamReassembler::Mode)
+    //! \param timestamps whether our SYN offers timestamps (see TCPConfig::timestamps)
+    TCPReceiver(const size_t capacity,
+                const ByteStream::Storage storage = ByteStream::Storage::Ring,
+                const StreamReassembler::Mode mode = StreamReassembler::Mode::Map,
+                const bool timestamps = false) : 
+    _reassembler(capacity, storage, mode), 
     _capacity(capacity),
     _syn_seen(false),
-    _isn(0)
+    _isn(0),
+    _timestamps(timestamps)
     {}
 
     //! \name Accessors to provide feedback to the remote TCPSender
@@ -57,11 +70,20 @@ class TCPReceiver {
     size_t window_size() const;
     //!@}
 
+    //! \brief SACK blocks (RFC 2018) for the out-of-order data held past the ackno
+    //! \returns up to `max_blocks` (left edge, right edge) pairs, most recently received first
+    std::vector<std::pair<WrappingInt32, WrappingInt32>> sack_blocks(const size_t max_blocks) const;
+
+    //! \brief The TSecr to put on our segments (TS.Recent, RFC 7323)
+    //! \returns empty unless both sides' SYNs carried timestamps
+    std::optional<uint32_t> ts_recent() const { return _ts_recent; }
+
     //! \brief number of bytes stored but not yet reassembled
     size_t unassembled_bytes() const { return _reassembler.unassembled_bytes(); }
 
     //! \brief handle an inbound segment
-    void segment_received(const TCPSegment &seg);
+    //! \returns false if the segment was dropped as an old duplicate (PAWS, RFC 7323 section 5)
+    bool segment_received(const TCPSegment &seg);
 
     //! \name "Output" interface for the reader
     //!@{
@@ -2,6 +2,9 @@
 
 #include "tcp_config.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <random>
 
 // Dummy implementation of a TCP sender
@@ -18,16 +21,101 @@ using namespace std;
 //! \param[in] retx_timeout the initial amount of time to wait before retransmitting the oldest outstanding segment
 //! \param[in] fixed_isn the Initial Sequence Number to use, if set (otherwise uses a random ISN)
 TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const std::optional<WrappingInt32> fixed_isn)
-    : _isn(fixed_isn.value_or(WrappingInt32{random_device()()}))
-    , _initial_retransmission_timeout{retx_timeout}
-    , _stream(capacity) {}
+    : TCPSender([&] {
+        TCPConfig config;
+        config.send_capacity = capacity;
+        config.rt_timeout = retx_timeout;
+        config.fixed_isn = fixed_isn;
+        return config;
+    }()) {}
 
-uint64_t TCPSender::bytes_in_flight() const { return _bytes_in_flight; }
+//! \param[in] config the sender reads send_capacity, send_storage, rt_timeout, fixed_isn, congestion_control,
+//! fast_retransmit, adaptive_rto, rto_min, rto_max, timestamps, mss, mtu_probing, coalescing, cork_timeout,
+//! pacing and pacing_gain
+TCPSender::TCPSender(const TCPConfig &config)
+    : _isn(config.fixed_isn.value_or(WrappingInt32{random_device()()}))
+    , _initial_retransmission_timeout{config.rt_timeout}
+    , _stream(config.send_capacity, config.send_storage)
+    , _fast_retransmit(config.fast_retransmit)
+    , _mss_limit(config.mss)
+    , _mss(config.mtu_probing ? min(config.mss, TCPConfig::MAX_PAYLOAD_SIZE) : config.mss)
+    , _mtu_probing(config.mtu_probing)
+    , _probe_ceiling(config.mss)
+    , _coalescing(config.coalescing)
+    , _cork_timeout(config.cork_timeout)
+    , _pacing(config.pacing)
+    , _pacing_gain(config.pacing_gain)
+    , _cc(CongestionControl::make(config.congestion_control, _mss))
+    , _cc_algorithm(config.congestion_control)
+    , _rto(config.rt_timeout)
+    , _adaptive_rto(config.adaptive_rto)
+    , _rto_min(config.rto_min)
+    , _rto_max(config.rto_max)
+    , _timestamps(config.timestamps) {}
+
+//! \param[in] peer_mss the MSS option from the peer's SYN
+//! \note Called during the handshake, so the congestion controller is simply rebuilt for the new size.
+void TCPSender::set_peer_mss(const size_t peer_mss) {
+    // 对端通告的 MSS 不可信时（比如 0），按 RFC 879 的默认值 536 处理，否则一个字节也发不出去
+    _mss_limit = min(_mss_limit, max(peer_mss, MIN_PEER_MSS));
+    _probe_ceiling = _mss_limit;
+    if (_mss <= _mss_limit)
+        return;
+    _mss = _mss_limit;
+    _cc = CongestionControl::make(_cc_algorithm, _mss);
+}
+
+//! \returns true if the data left in the stream is less than a full segment and coalescing says to wait:
+//! under Nagle, until everything sent is acked; under Cork, until `_cork_timeout` ms after it was first held.
+//! Never holds flushed bytes, or the last bytes before a FIN.
+bool TCPSender::hold_partial_segment_() {
+    const size_t buffered = stream_in().buffer_size();
+    if (_coalescing == TCPConfig::Coalescing::None || buffered == 0 || buffered >= _mss ||
+        stream_in().input_ended() || stream_in().bytes_read() < _push_until)
+        return false;
+    if (_coalescing == TCPConfig::Coalescing::Nagle)
+        return _bytes_in_flight > 0;
+    if (!_held_since.has_value())
+        _held_since = _time_ms;
+    return _time_ms - _held_since.value() < _cork_timeout;
+}
+
+void TCPSender::flush() {
+    _push_until = stream_in().bytes_written();
+    fill_window();
+}
+
+double TCPSender::pacing_rate() const {
+    if (!_pacing || !_srtt.has_value())
+        return 0;
+    const size_t window = min(cwnd(), max(_received_window, size_t{1}));
+    return _pacing_gain * double(window) / max(_srtt.value(), 1.0);
+}
+
+optional<size_t> TCPSender::pacing_delay() const {
+    const double rate = pacing_rate();
+    if (!_pacing_blocked || rate <= 0)
+        return {};
+    return max(size_t{1}, size_t(ceil(-_pacing_credit / rate)));
+}
+
+uint64_t TCPSender::bytes_in_flight() const { return _bytes_in_flight - _sacked_bytes; }
 
 void TCPSender::fill_window() {
+    _pacing_blocked = false;
+    // 先重传丢失的空洞，再发新数据（RFC 6675 NextSeg），两者共用同一个拥塞窗口
+    retransmit_lost_();
+    if (!_lost.empty())
+        return;
     size_t curr_window_size = _received_window ? _received_window : 1;
-    // 循环填充窗口
-    while (curr_window_size > _bytes_in_flight){
+    // 循环填充窗口：同时受接收窗口和拥塞窗口限制
+    while (curr_window_size > _bytes_in_flight && cwnd() > pipe_()){
+        const size_t cwnd_room = cwnd() - pipe_();
+        const size_t room = min(curr_window_size - _bytes_in_flight, cwnd_room);
+        // 受拥塞窗口限制时，不为凑满窗口而发送小段，等待更多ACK
+        if (room == cwnd_room && room < _mss && pipe_() > 0 &&
+            stream_in().buffer_size() > room)
+            break;
         TCPSegment seg;
         TCPHeader& header = seg.header();
 
@@ -36,20 +124,44 @@ void TCPSender::fill_window() {
             header.syn = true;
             _syn_sent = true;
         } 
+        // 小段合并（Nagle / cork）：不够一个 MSS 的数据先攒着
+        if (!header.syn && hold_partial_segment_())
+            break;
+        // 发送节奏（pacing）：额度用完了就等 tick() 补充，不一口气把整个窗口发出去
+        if (!header.syn && _pacing_credit < 0 && pacing_rate() > 0 &&
+            (stream_in().buffer_size() > 0 || (stream_in().eof() && !_fin_sent))) {
+            _pacing_blocked = true;
+            break;
+        }
         // 2) 正常数据
         header.seqno = wrap(_next_seqno, _isn);
-        size_t payload_size = min( curr_window_size - _bytes_in_flight - seg.header().syn, TCPConfig::MAX_PAYLOAD_SIZE);
-        string payload = stream_in().read(payload_size);
+        size_t payload_size = min(room - seg.header().syn, _mss);
+        // 路径MTU探测（RFC 4821）：连接建立后，一次只发一个探测段，大小取当前 MSS 与上限的中点
+        if (_mtu_probing && _highest_acked > 0 && !_probe_seqno.has_value() &&
+            _mss + PROBE_GRANULARITY <= _probe_ceiling) {
+            const size_t probe_size = (_mss + _probe_ceiling + 1) / 2;
+            if (room >= probe_size && stream_in().buffer_size() >= probe_size) {
+                payload_size = probe_size;
+                _probe_seqno = _next_seqno;
+                _probe_size = probe_size;
+            }
+        }
+        // 零拷贝：payload 直接是发送缓冲区里块的切片，只有跨块时才拷贝拼接
+        Buffer payload = stream_in().read_buffer(payload_size);
+        // payload 的校验和只算一次，首发和每次重传都只需再加上首部的和
+        payload.cache_partial_checksum();
 
         // 3) FIN（当EOF且还有空间且尚未发送过）
         // 含SYN/FIN seg.length_in_sequence_space();
-        bool can_fin = stream_in().eof() && !_fin_sent && payload.size() + _bytes_in_flight < curr_window_size;
+        bool can_fin = stream_in().eof() && !_fin_sent && payload.size() < room;
         if (can_fin) {
             seg.header().fin = true;
             _fin_sent = true;
         }
         
-        seg.payload() = Buffer(std::move(payload));
+        if (payload.size() > 0)
+            _held_since.reset();
+        seg.payload() = move(payload);
 
         // 若段完全为空（既无SYN/FIN也无payload），停止
         if (seg.length_in_sequence_space() == 0) 
@@ -57,66 +169,360 @@ void TCPSender::fill_window() {
 
         // 序号推进 & 记账
         if (_outstanding_segments.empty()) {
-            _current_retransmission_timeout = _initial_retransmission_timeout;
+            _current_retransmission_timeout = _rto;
             _timeout_count = 0;
         }
+        // 记账：未确认队列只记序号、长度和共享的 payload，重传时再重建首部
+        const size_t length = seg.length_in_sequence_space();
+        const bool fin = header.fin;
+        _outstanding_segments.push_back({_next_seqno, length, seg.payload(), header.syn, fin, _time_ms, false});
+        _bytes_in_flight += length;
+        _next_seqno += length;
+        if (pacing_rate() > 0)
+            _pacing_credit -= double(length);
         // 发送
-        _segments_out.push(seg);
-        // if(seg.length_in_sequence_space() > 0) 无影响
-        _outstanding_segments.insert(make_pair(_next_seqno, seg));
-        _bytes_in_flight += seg.length_in_sequence_space();
-        _next_seqno += seg.length_in_sequence_space();
-        
+        send_(move(seg));
+
         // 循环继续，直到无空间或无数据可读且不可发FIN
-        if (seg.header().fin) 
+        if (fin)
             break;
   }
 }
 
 //! \param ackno The remote receiver's ackno (acknowledgment number)
-//! \param window_size The remote receiver's advertised window size
-void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) { 
+//! \param window_size The remote receiver's advertised window field, before scaling (see set_window_scale())
+//! \param sack_blocks The SACK blocks carried by the same segment
+//! \param pure_ack Whether the segment carried no data, so a repeated ackno counts as a duplicate ACK
+//! \param ts_ecr The TSecr carried by the same segment (RFC 7323), if any
+void TCPSender::ack_received(const WrappingInt32 ackno,
+                             const uint16_t window_size,
+                             const vector<pair<WrappingInt32, WrappingInt32>> &sack_blocks,
+                             const bool pure_ack,
+                             const optional<uint32_t> ts_ecr) { 
     // unwrap 相对 _next_seqno，以避免倒退
     const uint64_t ack_abs = unwrap(ackno, _isn, _next_seqno);
+    // 窗口缩放（RFC 7323）：协商后窗口字段以 2^shift 字节为单位
+    const size_t window = static_cast<size_t>(window_size) << _window_shift;
 
     // 越界ACK（超前于已发送序号）→ ignore“推进”
     if (ack_abs > _next_seqno) 
         return; 
-    // 遍历数据结构，将已经接收到的数据包丢弃
-    for (auto iter = _outstanding_segments.begin(); iter != _outstanding_segments.end();) {
-        // 如果一个发送的数据包已经被成功接收
-        const TCPSegment &seg = iter->second;
-        if (iter->first + seg.length_in_sequence_space() <= ack_abs) {
-            _bytes_in_flight -= seg.length_in_sequence_space();
-            iter = _outstanding_segments.erase(iter);
-
-            // 如果有新的数据包被成功接收，则清空超时时间
-            _current_retransmission_timeout = _initial_retransmission_timeout;
-            _timeout_count = 0;
-        }
-        // 如果当前遍历到的数据包还没被接收，则说明后面的数据包均未被接收，因此直接返回
-        else
+    size_t bytes_acked = 0;
+    // RTT样本取自本次确认的最新一个未重传过的段（Karn算法）
+    optional<uint64_t> rtt_sample;
+    // 回显的时间戳不可能早于最早的未确认段的发送时间
+    const uint64_t oldest_sent_ms = _outstanding_segments.empty() ? _time_ms : _outstanding_segments.front().sent_ms;
+    // 从队头弹出已经被完整确认的段；遇到第一个没被确认的就停，后面的段也都没被确认
+    while (!_outstanding_segments.empty()) {
+        const OutstandingSegment &front = _outstanding_segments.front();
+        if (front.seqno + front.length > ack_abs)
             break;
+        if (!front.retransmitted)
+            rtt_sample = _time_ms - front.sent_ms;
+        // 探测段被确认：路径能通过这个大小
+        if (_probe_seqno == front.seqno) {
+            _mss = _probe_size;
+            _probe_seqno.reset();
+        }
+        _bytes_in_flight -= front.length;
+        bytes_acked += front.length;
+        if (!_sacked.empty() && _sacked.erase(front.seqno))
+            _sacked_bytes -= front.length;
+        if (!_sack_retransmitted.empty())
+            _sack_retransmitted.erase(front.seqno);
+        if (!_lost.empty() && _lost.erase(front.seqno))
+            _lost_bytes -= front.length;
+        _outstanding_segments.pop_front();
+    }
+    // 有时间戳回显时，每个确认新数据的ACK都能采样，重传过的段也可以（RFC 7323 section 4）。
+    // TSecr为0表示对端还没有回显；超前于我们时钟的TSecr（回绕后样本大于最早段的在途时间）不可信，
+    // 此时退回到上面按Karn算法取的样本
+    if (bytes_acked > 0 && ts_ecr.has_value() && ts_ecr.value() != 0) {
+        const uint32_t ts_sample = ts_clock_() - ts_ecr.value();
+        if (ts_sample <= _time_ms - oldest_sent_ms)
+            rtt_sample = ts_sample;
+    }
+    if (rtt_sample.has_value())
+        rtt_sample_(rtt_sample.value());
+    // 如果有新的数据包被成功接收，则清空超时时间
+    if (bytes_acked > 0) {
+        _current_retransmission_timeout = _rto;
+        _timeout_count = 0;
+    }
+    // 重复ACK（RFC 5681）：不携带数据，ackno和窗口都不变，且仍有未确认的数据
+    const bool new_ack = ack_abs > _highest_acked;
+    if (new_ack) {
+        _highest_acked = ack_abs;
+        _dup_acks = 0;
+    } else if (ack_abs == _highest_acked && pure_ack && window == _received_window &&
+               !_outstanding_segments.empty()) {
+        ++_dup_acks;
+    }
+
+    if (_in_recovery && ack_abs >= _recovery_point) {
+        _in_recovery = false;
+        _dupack_recovery = false;
+        _recovery_inflation = 0;
+    }
+    if (bytes_acked > 0 && !_in_recovery)
+        _cc->on_ack(bytes_acked, rtt_sample, _time_ms);
+
+    mark_sacked_(sack_blocks);
+
+    // 探测段之后的数据到了而探测段没到（DUPTHRESH 个重复ACK或被SACK的段）：按太大处理，拆开重传，不算拥塞
+    if (_probe_seqno.has_value() && _probe_seqno.value() == _highest_acked &&
+        (_dup_acks >= DUPTHRESH || _sacked.size() >= DUPTHRESH)) {
+        probe_failed_();
+        _dup_acks = 0;
+    }
+
+    if (!_fast_retransmit) {
+        // 只统计重复ACK，不据此重传
+    } else if (_dup_acks == DUPTHRESH && ack_abs >= _recovery_point) {
+        // 快速重传：第三个重复ACK，立即重传最早的未确认段，进入快速恢复
+        _cc->on_loss(_bytes_in_flight, _time_ms);
+        _recovery_point = _next_seqno;
+        _in_recovery = true;
+        // 每个重复ACK意味着一个段离开了网络；有SACK时 bytes_in_flight() 已经把它们扣除了
+        _recovery_inflation = _sacked.empty() ? DUPTHRESH * _mss : 0;
+        _dupack_recovery = true;
+        fast_retransmit_();
+    } else if (_dup_acks > DUPTHRESH && _in_recovery && _sacked.empty()) {
+        _recovery_inflation += _mss;
+    } else if (new_ack && _in_recovery && _dupack_recovery && _sacked.empty()) {
+        // 部分确认（RFC 6582）：下一个空洞也丢了，不等超时直接重传
+        _recovery_inflation -= min(_recovery_inflation, bytes_acked);
+        fast_retransmit_();
+    } else if (new_ack && _in_recovery && _dupack_recovery) {
+        // 有 SACK 时部分确认露出的空洞记入 _lost，和记分板找到的空洞一样受拥塞窗口限制
+        mark_lost_(_outstanding_segments.front());
+    }
+
+    // 记分板上的空洞：其上方已有 DUPTHRESH 个段被 SACK，视为丢失，记入 _lost，等拥塞窗口有空间时再重传
+    if (!_sacked.empty()) {
+        bool found_loss = false;
+        size_t sacked_above = 0;
+        for (auto iter = find_outstanding_(*_sacked.rbegin()); ; --iter) {
+            if (_sacked.count(iter->seqno)) {
+                ++sacked_above;
+            } else if (sacked_above >= DUPTHRESH && mark_lost_(*iter)) {
+                found_loss = true;
+            }
+            if (iter == _outstanding_segments.begin())
+                break;
+        }
+        // 每个窗口的数据最多通知一次丢包
+        if (found_loss && ack_abs >= _recovery_point) {
+            _cc->on_loss(_bytes_in_flight, _time_ms);
+            _recovery_point = _next_seqno;
+            _in_recovery = true;
+        }
     }
     // 每次收到ACK都重置计数器
     _consecutive_retx = 0;
+    // 零窗口被打开，但最早的段（零窗口探测）没有被确认。如果它已经发出一个 SRTT 以上（时钟粒度 G 为 1 ms），
+    // 或者已经重传过，说明它是因为没有空间被丢掉的，立即重传，不等超时；否则它可能还在路上，照常等它的确认
+    if (_received_window == 0 && window > 0 && !_outstanding_segments.empty() &&
+        _outstanding_segments.front().seqno == ack_abs) {
+        OutstandingSegment &probe = _outstanding_segments.front();
+        if (probe.retransmitted || (_srtt.has_value() && double(_time_ms - probe.sent_ms) + 1 >= _srtt.value())) {
+            retransmit_(probe);
+            _timeout_count = 0;
+        }
+    }
     // 填充后面的数据
-    _received_window = window_size;
+    _received_window = window;
     fill_window();
 }
 
+//! Marks every outstanding segment that lies entirely inside a SACK block.
+//! Segments carrying SYN or FIN are never marked: those flags cannot be SACKed,
+//! so bytes_in_flight() only reaches zero once everything is cumulatively acked.
+void TCPSender::mark_sacked_(const vector<pair<WrappingInt32, WrappingInt32>> &sack_blocks) {
+    for (const auto &[left, right] : sack_blocks) {
+        const uint64_t l = unwrap(left, _isn, _next_seqno);
+        const uint64_t r = unwrap(right, _isn, _next_seqno);
+        if (l >= r || r > _next_seqno)
+            continue;
+        for (auto iter = find_outstanding_(l); iter != _outstanding_segments.end(); ++iter) {
+            if (iter->seqno + iter->length > r)
+                break;
+            if (iter->syn || iter->fin || _sacked.count(iter->seqno))
+                continue;
+            _sacked.insert(iter->seqno);
+            _sacked_bytes += iter->length;
+            if (_lost.erase(iter->seqno))
+                _lost_bytes -= iter->length;
+        }
+    }
+}
+
+//! Resends the oldest outstanding segment, unless it is SACKed or was already resent since the last timeout.
+void TCPSender::fast_retransmit_() {
+    if (_outstanding_segments.empty())
+        return;
+    OutstandingSegment &outstanding = _outstanding_segments.front();
+    if (_sacked.count(outstanding.seqno) || _sack_retransmitted.count(outstanding.seqno))
+        return;
+    ++_fast_retransmits;
+    resend_hole_(outstanding);
+}
+
+//! Adds a hole to `_lost`, unless it is SACKed, was already resent since the last timeout, or is already there.
+//! \returns whether it was added
+bool TCPSender::mark_lost_(const OutstandingSegment &outstanding) {
+    if (_sacked.count(outstanding.seqno) || _sack_retransmitted.count(outstanding.seqno) ||
+        !_lost.insert(outstanding.seqno).second)
+        return false;
+    _lost_bytes += outstanding.length;
+    return true;
+}
+
+//! Resends a hole, which then counts as in flight again rather than lost.
+void TCPSender::resend_hole_(OutstandingSegment &outstanding) {
+    _sack_retransmitted.insert(outstanding.seqno);
+    if (_lost.erase(outstanding.seqno))
+        _lost_bytes -= outstanding.length;
+    retransmit_(outstanding);
+}
+
+//! RFC 6675 NextSeg(): resends the lost holes in seqno order, while the congestion window has room for them.
+void TCPSender::retransmit_lost_() {
+    while (!_lost.empty() && pipe_() < cwnd())
+        resend_hole_(*find_outstanding_(*_lost.begin()));
+}
+
+//! RFC 6675 SetPipe(): the bytes still in the network, i.e. bytes_in_flight() less the lost holes not yet resent
+size_t TCPSender::pipe_() const { return bytes_in_flight() - _lost_bytes; }
+
+size_t TCPSender::cwnd() const {
+    const size_t cwnd = _cc->cwnd();
+    return cwnd > numeric_limits<size_t>::max() - _recovery_inflation ? cwnd : cwnd + _recovery_inflation;
+}
+
+//! \returns the first outstanding segment that starts at or after absolute seqno `seqno`
+deque<TCPSender::OutstandingSegment>::iterator TCPSender::find_outstanding_(const uint64_t seqno) {
+    return lower_bound(_outstanding_segments.begin(),
+                       _outstanding_segments.end(),
+                       seqno,
+                       [](const OutstandingSegment &outstanding, const uint64_t n) { return outstanding.seqno < n; });
+}
+
+void TCPSender::retransmit_(OutstandingSegment &outstanding) {
+    // Karn: 重传过的段不能用来采样RTT
+    outstanding.retransmitted = true;
+    outstanding.sent_ms = _time_ms;
+    // 按记录重建首部，payload 与原来的段共享
+    TCPSegment segment;
+    segment.header().seqno = wrap(outstanding.seqno, _isn);
+    segment.header().syn = outstanding.syn;
+    segment.header().fin = outstanding.fin;
+    segment.payload() = outstanding.payload;
+    send_(move(segment));
+    _retransmitted_bytes += outstanding.length;
+}
+
+//! A probe was lost: lower the ceiling of the search, and resend the probe's bytes
+//! right away in segments of the current MSS (a lost probe is not a congestion signal).
+void TCPSender::probe_failed_() {
+    const uint64_t seqno = _probe_seqno.value();
+    _probe_seqno.reset();
+    _probe_ceiling = _probe_size - 1;
+
+    auto iter = find_outstanding_(seqno);
+    const OutstandingSegment probe = move(*iter);
+    iter = _outstanding_segments.erase(iter);
+    if (_sacked.erase(seqno))
+        _sacked_bytes -= probe.length;
+    if (_lost.erase(seqno))
+        _lost_bytes -= probe.length;
+    const string_view payload = probe.payload.str();
+    vector<OutstandingSegment> pieces;
+    for (size_t offset = 0; offset < payload.size(); offset += _mss) {
+        Buffer piece = probe.payload.substr(offset, _mss);
+        piece.cache_partial_checksum();
+        const bool fin = probe.fin && offset + _mss >= payload.size();
+        pieces.push_back({seqno + offset, piece.size() + fin, move(piece), false, fin, probe.sent_ms, true});
+    }
+    iter = _outstanding_segments.insert(iter, make_move_iterator(pieces.begin()), make_move_iterator(pieces.end()));
+    for (size_t i = 0; i < pieces.size(); ++i, ++iter) {
+        _sack_retransmitted.insert(iter->seqno);
+        retransmit_(*iter);
+    }
+}
+
+//! RFC 6298 section 2: fold one RTT measurement into SRTT and RTTVAR, and recompute the RTO.
+void TCPSender::rtt_sample_(const uint64_t rtt_ms) {
+    const double r = double(rtt_ms);
+    if (!_srtt.has_value()) {
+        _srtt = r;
+        _rttvar = r / 2;
+    } else {
+        _rttvar = 0.75 * _rttvar + 0.25 * abs(_srtt.value() - r);
+        _srtt = 0.875 * _srtt.value() + 0.125 * r;
+    }
+    if (!_adaptive_rto)
+        return;
+    // 时钟粒度 G 为 1 ms
+    const double rto = _srtt.value() + max(1.0, 4 * _rttvar);
+    _rto = clamp(size_t(ceil(rto)), _rto_min, _rto_max);
+}
+
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPSender::tick(const size_t ms_since_last_tick) { 
     _timeout_count += ms_since_last_tick;
+    _time_ms += ms_since_last_tick;
+
+    // cork 到时间了：攒着的小段不再等待
+    if (_held_since.has_value() && _time_ms - _held_since.value() >= _cork_timeout)
+        fill_window();
+
+    // pacing：按速率补充额度，最多攒一个 tick 的量（至少一个 MSS），再放出被挡住的段
+    const double rate = pacing_rate();
+    if (rate > 0) {
+        const double earned = rate * double(ms_since_last_tick);
+        _pacing_credit = min(_pacing_credit + earned, max(double(_mss), earned));
+        if (_pacing_blocked && _pacing_credit >= 0)
+            fill_window();
+    }
 
     auto iter = _outstanding_segments.begin();
+    // 最早的未确认段是探测段且超时：按探测失败处理，不退避
+    if (iter != _outstanding_segments.end() && _timeout_count >= _current_retransmission_timeout &&
+        _probe_seqno == iter->seqno) {
+        probe_failed_();
+        _timeout_count = 0;
+        return;
+    }
     // 如果存在发送中的数据包，并且定时器超时
     if (iter != _outstanding_segments.end() && _timeout_count >= _current_retransmission_timeout) {
         // 如果窗口大小不为0还超时，则说明网络拥堵
-        if (_received_window > 0)
+        if (_received_window > 0) {
             _current_retransmission_timeout *= 2;
+            if (_adaptive_rto)
+                _current_retransmission_timeout = min(_current_retransmission_timeout, _rto_max);
+            _cc->on_rto(_bytes_in_flight, _time_ms);
+            _recovery_point = _next_seqno;
+            _in_recovery = false;
+        }
         _timeout_count = 0;
-        _segments_out.push(iter->second);
+        ++_timeouts;
+        _dup_acks = 0;
+        _recovery_inflation = 0;
+        _dupack_recovery = false;
+        if (_sacked.empty()) {
+            retransmit_(*iter);
+        } else {
+            // 有 SACK 信息时，最高 SACK 段之下的空洞都视为丢失；超时只重传第一个（它一定没被 SACK），
+            // 其余的等 ACK 回来、拥塞窗口有空间时再重传
+            _sack_retransmitted.clear();
+            _lost.clear();
+            _lost_bytes = 0;
+            const uint64_t highest_sacked = *_sacked.rbegin();
+            for (auto hole = next(iter); hole != _outstanding_segments.end() && hole->seqno < highest_sacked; ++hole)
+                mark_lost_(*hole);
+            resend_hole_(*iter);
+        }
         // 连续重传计时器增加
         ++_consecutive_retx;
     }
@@ -127,5 +533,12 @@ unsigned int TCPSender::consecutive_retransmissions() const { return _consecutiv
 void TCPSender::send_empty_segment() {
     TCPSegment segment;
     segment.header().seqno = next_seqno();
-    _segments_out.push(segment);
+    send_(move(segment));
+}
+
+//! Queues a segment, with our clock as its TSval if timestamps are on (the TCPConnection fills in TSecr).
+void TCPSender::send_(TCPSegment segment) {
+    if (_timestamps)
+        segment.header().timestamps.emplace(ts_clock_(), 0);
+    _segments_out.push(move(segment));
 }
@@ -2,12 +2,18 @@
 #define SPONGE_LIBSPONGE_TCP_SENDER_HH
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
-#include <map>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <queue>
+#include <set>
+#include <utility>
+#include <vector>
 
 //! \brief The "sender" part of a TCP implementation.
 
@@ -36,12 +42,26 @@ class TCPSender {
     
     uint64_t _highest_acked = 0; //目前已确认的最右绝对序号（ACK 左闭右开语义）。
 
-    std::map<size_t, TCPSegment> _outstanding_segments{};
-    // std::deque<TCPSegment> _outstanding_segments;
+    //! a segment that has been sent and not yet acknowledged; its header is rebuilt if it is resent
+    struct OutstandingSegment {
+        uint64_t seqno;      //!< absolute seqno of its first byte (or of its SYN)
+        size_t length;       //!< length in sequence space
+        Buffer payload;      //!< shares the bytes of the segment that was sent
+        bool syn, fin;
+        uint64_t sent_ms;    //!< `_time_ms` when it was (last) sent
+        bool retransmitted;  //!< Karn's algorithm: a resent segment gives no RTT sample
+    };
+
+    //! outstanding segments in seqno order: sent at the back, cumulatively acked off the front
+    std::deque<OutstandingSegment> _outstanding_segments{};
 
     size_t _bytes_in_flight = 0;
 
-    uint16_t _received_window = 1;
+    //! the peer's window, in bytes (already scaled)
+    size_t _received_window = 1;
+
+    //! shift applied to the window field of the peer's ACKs (RFC 7323 window scaling)
+    uint8_t _window_shift = 0;
 
     unsigned int _consecutive_retx = 0;
 
@@ -50,6 +70,116 @@ class TCPSender {
     size_t _timeout_count = 0;
 
     bool _syn_sent= false, _fin_sent = false;
+
+    //! SACK scoreboard: absolute seqnos of outstanding segments the receiver already holds
+    std::set<uint64_t> _sacked{};
+
+    //! holes already retransmitted on SACK or duplicate-ACK evidence since the last timeout
+    std::set<uint64_t> _sack_retransmitted{};
+
+    //! holes judged lost (by the scoreboard, or below the highest SACK at a timeout) and not yet resent
+    std::set<uint64_t> _lost{};
+
+    //! sequence-space bytes of the segments in `_lost`
+    size_t _lost_bytes = 0;
+
+    //! sequence-space bytes of the segments in `_sacked`
+    size_t _sacked_bytes = 0;
+
+    //! total sequence-space bytes sent more than once
+    uint64_t _retransmitted_bytes = 0;
+
+    //! a segment counts as lost after this many duplicate ACKs (RFC 5681),
+    //! or once this many SACKed segments lie above it (RFC 6675 DupThresh)
+    static constexpr size_t DUPTHRESH = 3;
+
+    //! duplicate ACKs in a row for `_highest_acked`
+    size_t _dup_acks = 0;
+
+    //! resend on the third duplicate ACK (TCPConfig::fast_retransmit)
+    bool _fast_retransmit;
+
+    //! the current recovery was entered on duplicate ACKs, so partial ACKs resend the next hole
+    bool _dupack_recovery = false;
+
+    //! fast recovery: cwnd inflation for segments that duplicate ACKs say have left the network
+    size_t _recovery_inflation = 0;
+
+    uint64_t _fast_retransmits = 0;
+    uint64_t _timeouts = 0;
+
+    //! \name Segment sizing
+    //!@{
+    size_t _mss_limit;                       //!< largest payload we may send: TCPConfig::mss, or the peer's MSS
+    size_t _mss;                             //!< payload size of a full segment; below the limit only while probing
+    bool _mtu_probing;                       //!< TCPConfig::mtu_probing
+    size_t _probe_ceiling;                   //!< largest size not yet seen to fail as a probe
+    std::optional<uint64_t> _probe_seqno{};  //!< absolute seqno of the outstanding probe, if any
+    size_t _probe_size = 0;
+    //! stop probing once `_mss` is this close to `_probe_ceiling`
+    static constexpr size_t PROBE_GRANULARITY = 64;
+    //! a peer's MSS option below this (e.g. 0) is not believed: it is raised to the RFC 879 default
+    static constexpr size_t MIN_PEER_MSS = 536;
+    //!@}
+
+    //! \name Small-write coalescing
+    //!@{
+    TCPConfig::Coalescing _coalescing;
+    size_t _cork_timeout;
+    std::optional<uint64_t> _held_since{};  //!< `_time_ms` when a partial segment was first held back
+    uint64_t _push_until = 0;               //!< stream bytes before this index were flushed, and are never held
+    //!@}
+
+    bool hold_partial_segment_();
+
+    //! \name Pacing
+    //!@{
+    bool _pacing;                  //!< TCPConfig::pacing
+    double _pacing_gain;           //!< TCPConfig::pacing_gain
+    double _pacing_credit = 0;     //!< bytes that may go out now; negative while the last segment is paid off
+    bool _pacing_blocked = false;  //!< fill_window() stopped with data waiting because the credit ran out
+    //!@}
+
+    //! sizes the congestion window
+    std::unique_ptr<CongestionControl> _cc;
+    CongestionControl::Algorithm _cc_algorithm;
+
+    //! milliseconds of tick() since construction
+    uint64_t _time_ms = 0;
+
+    //! \name RTT estimation (RFC 6298), in milliseconds
+    //!@{
+    std::optional<double> _srtt{};  //!< smoothed RTT; empty until the first sample
+    double _rttvar = 0;             //!< RTT variation
+    size_t _rto;                    //!< the value a freshly started timer gets
+    bool _adaptive_rto;             //!< TCPConfig::adaptive_rto: arm the timer with the computed RTO
+    size_t _rto_min, _rto_max;
+    //!@}
+
+    void rtt_sample_(const uint64_t rtt_ms);
+
+    //! TCPConfig::timestamps: put our clock in TSval on every segment sent
+    bool _timestamps;
+
+    //! \returns the TSval clock, which starts at 1 so that a TSecr of 0 always means "nothing echoed yet"
+    uint32_t ts_clock_() const { return static_cast<uint32_t>(_time_ms + 1); }
+
+    //! no new loss is reported to `_cc` until the ackno reaches this point
+    uint64_t _recovery_point = 0;
+
+    //! a loss was reported and the window it happened in is not yet acked
+    bool _in_recovery = false;
+
+    void mark_sacked_(const std::vector<std::pair<WrappingInt32, WrappingInt32>> &sack_blocks);
+    std::deque<OutstandingSegment>::iterator find_outstanding_(const uint64_t seqno);
+    void retransmit_(OutstandingSegment &outstanding);
+    void fast_retransmit_();
+    bool mark_lost_(const OutstandingSegment &outstanding);
+    void resend_hole_(OutstandingSegment &outstanding);
+    void retransmit_lost_();
+    size_t pipe_() const;
+    void send_(TCPSegment segment);
+    void probe_failed_();
   
   
   public:
@@ -58,6 +188,9 @@ class TCPSender {
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
               const std::optional<WrappingInt32> fixed_isn = {});
 
+    //! Initialize a TCPSender from the sender-side fields of a TCPConfig
+    explicit TCPSender(const TCPConfig &config);
+
     //! \name "Input" interface for the writer
     //!@{
     ByteStream &stream_in() { return _stream; }
@@ -68,7 +201,22 @@ class TCPSender {
     //!@{
 
     //! \brief A new acknowledgment was received
-    void ack_received(const WrappingInt32 ackno, const uint16_t window_size);
+    //! \param sack_blocks SACK blocks from the same segment, if SACK was negotiated
+    //! \param pure_ack false if the segment carried data (then a repeated ackno is not a duplicate ACK)
+    //! \param ts_ecr TSecr from the same segment, if timestamps were negotiated
+    void ack_received(const WrappingInt32 ackno,
+                      const uint16_t window_size,
+                      const std::vector<std::pair<WrappingInt32, WrappingInt32>> &sack_blocks = {},
+                      const bool pure_ack = true,
+                      const std::optional<uint32_t> ts_ecr = {});
+
+    //! \brief Window scaling was negotiated: from now on, shift the peer's window field left by `shift`
+    //! \note Call this after the ACK on the peer's SYN, whose window field is never scaled
+    void set_window_scale(const uint8_t shift) { _window_shift = shift; }
+
+    //! \brief The peer's SYN carried an MSS option: never send a larger payload than `peer_mss`
+    //! (or than MIN_PEER_MSS, if the option is smaller than that)
+    void set_peer_mss(const size_t peer_mss);
 
     //! \brief Generate an empty-payload segment (useful for creating empty ACK segments)
     void send_empty_segment();
@@ -76,6 +224,9 @@ class TCPSender {
     //! \brief create and send segments to fill as much of the window as possible
     void fill_window();
 
+    //! \brief Send everything written so far without waiting to coalesce it (see TCPConfig::coalescing)
+    void flush();
+
     //! \brief Notifies the TCPSender of the passage of time
     void tick(const size_t ms_since_last_tick);
     //!@}
@@ -86,8 +237,45 @@ class TCPSender {
     //! \brief How many sequence numbers are occupied by segments sent but not yet acknowledged?
     //! \note count is in "sequence space," i.e. SYN and FIN each count for one byte
     //! (see TCPSegment::length_in_sequence_space())
+    //! \note bytes the receiver has SACKed are not counted
     size_t bytes_in_flight() const;
 
+    //! \brief Payload size of a full segment right now
+    size_t mss() const { return _mss; }
+
+    //! \brief Largest payload this sender may ever send (the negotiated MSS)
+    size_t mss_limit() const { return _mss_limit; }
+
+    //! \brief The congestion window, in bytes (see CongestionControl), inflated during fast recovery
+    size_t cwnd() const;
+
+    //! \brief Rate new segments are paced at, in bytes per ms: cwnd (or the peer's window, if smaller)
+    //! per SRTT, times TCPConfig::pacing_gain. 0 means unpaced: pacing is off, or there is no RTT sample yet.
+    double pacing_rate() const;
+
+    //! \brief If pacing is holding data back, the ms until tick() will release the next segment
+    //! \note An event loop can use this to tick() sooner than it otherwise would
+    std::optional<size_t> pacing_delay() const;
+
+    //! \brief How many sequence numbers have been sent more than once?
+    uint64_t retransmitted_bytes() const { return _retransmitted_bytes; }
+
+    //! \brief Smoothed round-trip time in ms (0 before the first sample)
+    double srtt() const { return _srtt.value_or(0); }
+
+    //! \brief Round-trip time variation in ms (0 before the first sample)
+    double rttvar() const { return _rttvar; }
+
+    //! \brief The retransmission timeout a new timer starts with, in ms
+    //! \note Without TCPConfig::adaptive_rto this stays at rt_timeout; the estimate is kept for monitoring.
+    size_t rto() const { return _rto; }
+
+    //! \brief How many segments were resent on duplicate ACKs, without waiting for the timer?
+    uint64_t fast_retransmits() const { return _fast_retransmits; }
+
+    //! \brief How many times has the retransmission timer expired?
+    uint64_t timeouts() const { return _timeouts; }
+
     //! \brief Number of consecutive retransmissions that have occurred in a row
     unsigned int consecutive_retransmissions() const;
 
@@ -1,17 +1,48 @@
 #include "buffer.hh"
 
+#include "util.hh"
+
 using namespace std;
 
 void Buffer::remove_prefix(const size_t n) {
-    if (n > str().size()) {
+    if (n > _size) {
         throw out_of_range("Buffer::remove_prefix");
     }
+    if (n > 0) {
+        _partial_checksum.reset();
+    }
     _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
+    _size -= n;
+    if (_storage and _size == 0) {
         _storage.reset();
     }
 }
 
+void Buffer::cache_partial_checksum() {
+    if (_partial_checksum.has_value()) {
+        return;
+    }
+    InternetChecksum check;
+    check.add(str());
+    _partial_checksum = check.sum();
+}
+
+Buffer Buffer::substr(const size_t pos, const size_t n) const {
+    if (pos > _size) {
+        throw out_of_range("Buffer::substr");
+    }
+    Buffer ret{*this};
+    ret._starting_offset += pos;
+    ret._size = min(n, _size - pos);
+    if (ret._size != _size) {
+        ret._partial_checksum.reset();
+    }
+    if (ret._size == 0) {
+        ret._storage.reset();
+    }
+    return ret;
+}
+
 void BufferList::append(const BufferList &other) {
     for (const auto &buf : other._buffers) {
         _buffers.push_back(buf);
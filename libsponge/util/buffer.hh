@@ -2,9 +2,11 @@
 #define SPONGE_LIBSPONGE_BUFFER_HH
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -16,12 +18,27 @@ class Buffer {
   private:
     std::shared_ptr<std::string> _storage{};
     size_t _starting_offset{};
+    size_t _size{};  //!< bytes visible from `_starting_offset` (less than the rest of `_storage` for a slice)
+    std::optional<uint16_t> _partial_checksum{};  //!< InternetChecksum::sum() of the visible bytes, if known
 
   public:
     Buffer() = default;
 
     //! \brief Construct by taking ownership of a string
-    Buffer(std::string &&str) noexcept : _storage(std::make_shared<std::string>(std::move(str))) {}
+    Buffer(std::string &&str) noexcept
+        : _storage(std::make_shared<std::string>(std::move(str))), _size(_storage->size()) {}
+
+    //! \brief Construct by taking ownership of a string whose InternetChecksum::sum() was computed
+    //! as it was copied (see InternetChecksum::add_copy)
+    Buffer(std::string &&str, const uint16_t partial_checksum) noexcept : Buffer(std::move(str)) {
+        _partial_checksum = partial_checksum;
+    }
+
+    //! \brief Construct as the `size` bytes at `offset` in `storage`, which is shared with its owner
+    //! \note The owner may append to `storage` within its capacity (see ByteStream::write_view), which never
+    //! moves or changes the bytes this Buffer shows.
+    Buffer(std::shared_ptr<std::string> storage, const size_t offset, const size_t size)
+        : _storage(std::move(storage)), _starting_offset(offset), _size(size) {}
 
     //! \name Expose contents as a std::string_view
     //!@{
@@ -29,7 +46,7 @@ class Buffer {
         if (not _storage) {
             return {};
         }
-        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset};
+        return {_storage->data() + _starting_offset, _size};
     }
 
     operator std::string_view() const { return str(); }
@@ -39,11 +56,26 @@ class Buffer {
     uint8_t at(const size_t n) const { return str().at(n); }
 
     //! \brief Size of the string
-    size_t size() const { return str().size(); }
+    size_t size() const { return _size; }
+
+    //! \brief Whether the bytes live in `storage` (see the shared-storage constructor)
+    bool shares_storage(const std::shared_ptr<std::string> &storage) const { return _storage == storage; }
 
     //! \brief Make a copy to a new std::string
     std::string copy() const { return std::string(str()); }
 
+    //! \brief The InternetChecksum::sum() of the bytes, if it is already known
+    //! \note Slicing or trimming the Buffer forgets it.
+    std::optional<uint16_t> partial_checksum() const { return _partial_checksum; }
+
+    //! \brief Compute and remember the InternetChecksum::sum() of the bytes, unless it is already known
+    //! \note Copies of the Buffer made after this call carry the value, so a payload that is sent more than once
+    //! is only summed once.
+    void cache_partial_checksum();
+
+    //! \brief A Buffer of `n` bytes starting at `pos`, sharing this one's storage (does not copy)
+    Buffer substr(const size_t pos, const size_t n = std::string::npos) const;
+
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
     void remove_prefix(const size_t n);
@@ -102,6 +134,9 @@ class BufferViewList {
     //! \name Constructors
     //!@{
 
+    //! \brief Construct an empty list
+    BufferViewList() = default;
+
     //! \brief Construct from a std::string
     BufferViewList(const std::string &str) : BufferViewList(std::string_view(str)) {}
 
@@ -115,6 +150,13 @@ class BufferViewList {
     BufferViewList(std::string_view str) { _views.push_back({const_cast<char *>(str.data()), str.size()}); }
     //!@}
 
+    //! \brief Append a std::string_view (empty views are skipped)
+    void append(std::string_view str) {
+        if (not str.empty()) {
+            _views.push_back(str);
+        }
+    }
+
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     void remove_prefix(size_t n);
 
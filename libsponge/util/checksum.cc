@@ -0,0 +1,257 @@
+#include "util.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPONGE_CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Every kernel sums the 16-bit words of an even-length span in native byte order, into a 64-bit accumulator.
+// One's-complement addition is byte-order independent (RFC 1071, section 2(B)): folding that sum to 16 bits
+// and swapping its bytes on a little-endian machine gives the same result as summing big-endian words.
+namespace {
+
+constexpr size_t MIN_SIMD_BYTES = 64;
+
+// With `copy` set, each kernel also stores the bytes it loads to `dst`, so a copy costs no extra pass.
+template <bool copy>
+uint64_t sum_word64(const char *p, size_t n, char *dst, uint64_t sum = 0) {
+    for (; n >= 8; p += 8, dst += copy ? 8 : 0, n -= 8) {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        if constexpr (copy) {
+            memcpy(dst, &w, sizeof(w));
+        }
+        sum += (w & 0xffffffff) + (w >> 32);
+    }
+    for (; n >= 2; p += 2, dst += copy ? 2 : 0, n -= 2) {
+        uint16_t w;
+        memcpy(&w, p, sizeof(w));
+        if constexpr (copy) {
+            memcpy(dst, &w, sizeof(w));
+        }
+        sum += w;
+    }
+    return sum;
+}
+
+#ifdef SPONGE_CHECKSUM_X86
+// Each block adds at most 2 * 0xffff to a 32-bit lane, so the lanes are flushed before they can overflow.
+constexpr size_t MAX_BLOCKS_PER_FLUSH = 16384;
+
+template <bool copy>
+[[gnu::target("sse2")]] uint64_t sum_sse2(const char *p, size_t n, char *dst) {
+    uint64_t sum = 0;
+    const __m128i zero = _mm_setzero_si128();
+    while (n >= 32) {
+        const size_t blocks = min(n / 32, MAX_BLOCKS_PER_FLUSH);
+        // two accumulators, so that consecutive additions don't wait on each other
+        __m128i acc0 = zero, acc1 = zero;
+        for (size_t i = 0; i < blocks; i++, p += 32, dst += copy ? 32 : 0) {
+            const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+            if constexpr (copy) {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), v0);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), v1);
+            }
+            acc0 = _mm_add_epi32(acc0, _mm_add_epi32(_mm_unpacklo_epi16(v0, zero), _mm_unpackhi_epi16(v0, zero)));
+            acc1 = _mm_add_epi32(acc1, _mm_add_epi32(_mm_unpacklo_epi16(v1, zero), _mm_unpackhi_epi16(v1, zero)));
+        }
+        n -= blocks * 32;
+        alignas(16) uint32_t lanes[8];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes), acc0);
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes + 4), acc1);
+        for (const uint32_t lane : lanes) {
+            sum += lane;
+        }
+    }
+    return sum_word64<copy>(p, n, dst, sum);
+}
+
+template <bool copy>
+[[gnu::target("avx2")]] uint64_t sum_avx2(const char *p, size_t n, char *dst) {
+    uint64_t sum = 0;
+    const __m256i zero = _mm256_setzero_si256();
+    while (n >= 64) {
+        const size_t blocks = min(n / 64, MAX_BLOCKS_PER_FLUSH);
+        __m256i acc0 = zero, acc1 = zero;
+        for (size_t i = 0; i < blocks; i++, p += 64, dst += copy ? 64 : 0) {
+            const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+            if constexpr (copy) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), v0);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 32), v1);
+            }
+            acc0 = _mm256_add_epi32(
+                acc0, _mm256_add_epi32(_mm256_unpacklo_epi16(v0, zero), _mm256_unpackhi_epi16(v0, zero)));
+            acc1 = _mm256_add_epi32(
+                acc1, _mm256_add_epi32(_mm256_unpacklo_epi16(v1, zero), _mm256_unpackhi_epi16(v1, zero)));
+        }
+        n -= blocks * 64;
+        alignas(32) uint32_t lanes[16];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc0);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes + 8), acc1);
+        for (const uint32_t lane : lanes) {
+            sum += lane;
+        }
+    }
+    return sum_word64<copy>(p, n, dst, sum);
+}
+#endif
+
+uint16_t swap_bytes(const uint16_t x) { return (x << 8) | (x >> 8); }
+
+uint16_t fold(uint64_t sum) {
+    while (sum > 0xffff) {
+        sum = (sum >> 16) + (sum & 0xffff);
+    }
+    return sum;
+}
+
+}  // namespace
+
+InternetChecksum::Kernel InternetChecksum::best_kernel() {
+    static const Kernel best = [] {
+        for (const Kernel kernel : {Kernel::AVX2, Kernel::SSE2}) {
+            if (supported(kernel)) {
+                return kernel;
+            }
+        }
+        return Kernel::Word64;
+    }();
+    return best;
+}
+
+bool InternetChecksum::supported(const Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+        case Kernel::Word64:
+            return true;
+#ifdef SPONGE_CHECKSUM_X86
+        case Kernel::SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case Kernel::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+//! \note This class returns the checksum in host byte order.
+//!       See https://commandcenter.blogspot.com/2012/04/byte-order-fallacy.html for rationale
+//! \details This class can be used to either check or compute an Internet checksum
+//! (e.g., for an IP datagram header or a TCP segment).
+//!
+//! The Internet checksum is defined such that evaluating inet_cksum() on a TCP segment (IP datagram, etc)
+//! containing a correct checksum header will return zero. In other words, if you read a correct TCP segment
+//! off the wire and pass it untouched to inet_cksum(), the return value will be 0.
+//!
+//! Meanwhile, to compute the checksum for an outgoing TCP segment (IP datagram, etc.), you must first set
+//! the checksum header to zero, then call inet_cksum(), and finally set the checksum header to the return
+//! value.
+//!
+//! For more information, see the [Wikipedia page](https://en.wikipedia.org/wiki/IPv4_header_checksum)
+//! on the Internet checksum, and consult the [IP](\ref rfc::rfc791) and [TCP](\ref rfc::rfc793) RFCs.
+//!
+//! A kernel the CPU does not support is replaced by Kernel::Word64.
+InternetChecksum::InternetChecksum(const uint32_t initial_sum, const Kernel kernel)
+    : _sum(initial_sum), _kernel(supported(kernel) ? kernel : Kernel::Word64) {}
+
+//! Successive calls continue where the last one stopped: a span that starts at an odd offset into the
+//! checksummed data contributes its first byte as the low half of a 16-bit word.
+void InternetChecksum::add(std::string_view data) { add_span<false>(nullptr, data); }
+
+//! \param[out] dst receives a copy of `src`, and must have room for `src.size()` bytes
+//! \param[in] src is the data to add
+void InternetChecksum::add_copy(char *dst, std::string_view src) { add_span<true>(dst, src); }
+
+//! \param[in] sum is the sum() of a span checksummed on its own (from an initial sum of 0)
+//! \param[in] length is the span's length in bytes
+//! \details Equivalent to add() on the span itself: one's-complement sums can be combined in any order,
+//! and a span that lands at an odd offset has its bytes swapped.
+void InternetChecksum::add_sum(const uint16_t sum, const size_t length) {
+    _sum = fold(uint64_t{_sum} + (_parity ? swap_bytes(sum) : sum));
+    _parity = _parity != (length % 2 == 1);
+}
+
+template <bool copy>
+void InternetChecksum::add_span(char *dst, std::string_view data) {
+    if (_kernel == Kernel::Scalar) {
+        for (size_t i = 0; i < data.size(); i++) {
+            uint16_t val = uint8_t(data[i]);
+            if constexpr (copy) {
+                dst[i] = data[i];
+            }
+            if (not _parity) {
+                val <<= 8;
+            }
+            _sum += val;
+            _parity = !_parity;
+        }
+        return;
+    }
+
+    if (data.empty()) {
+        return;
+    }
+    uint64_t sum = _sum;
+    if (_parity) {
+        sum += uint8_t(data.front());
+        if constexpr (copy) {
+            *dst++ = data.front();
+        }
+        data.remove_prefix(1);
+        _parity = false;
+    }
+
+    const size_t even = data.size() & ~size_t{1};
+    uint64_t words = 0;
+    // below a few vectors, setting up and reducing the SIMD lanes costs more than it saves
+    switch (even < MIN_SIMD_BYTES ? Kernel::Word64 : _kernel) {
+#ifdef SPONGE_CHECKSUM_X86
+        case Kernel::AVX2:
+            words = sum_avx2<copy>(data.data(), even, dst);
+            break;
+        case Kernel::SSE2:
+            words = sum_sse2<copy>(data.data(), even, dst);
+            break;
+#endif
+        default:
+            words = sum_word64<copy>(data.data(), even, dst);
+            break;
+    }
+    uint16_t folded = fold(words);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    folded = swap_bytes(folded);
+#endif
+    sum += folded;
+
+    if (data.size() > even) {
+        sum += uint16_t(uint8_t(data.back())) << 8;
+        if constexpr (copy) {
+            dst[even] = data.back();
+        }
+        _parity = true;
+    }
+    _sum = fold(sum);
+}
+
+//! \returns the one's-complement sum of everything added so far, folded to 16 bits but not inverted
+uint16_t InternetChecksum::sum() const {
+    uint32_t ret = _sum;
+
+    while (ret > 0xffff) {
+        ret = (ret >> 16) + (ret & 0xffff);
+    }
+
+    return ret;
+}
+
+uint16_t InternetChecksum::value() const { return ~sum(); }
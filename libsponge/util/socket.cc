@@ -3,6 +3,9 @@
 #include "util.hh"
 
 #include <cstddef>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/udp.h>
 #include <stdexcept>
 #include <unistd.h>
 
@@ -112,6 +115,52 @@ UDPSocket::received_datagram UDPSocket::recv(const size_t mtu) {
     return ret;
 }
 
+//! \details Only the slots' storage is allocated here; each iovec and mmsghdr points at its slot for good.
+UDPSocket::received_batch::received_batch(const size_t slots, const size_t mtu)
+    : _storage(new char[slots * mtu])
+    , _source_addresses(slots)
+    , _iovecs(slots)
+    , _messages(slots) {
+    for (size_t i = 0; i < slots; i++) {
+        _iovecs[i] = {_storage.get() + i * mtu, mtu};
+        _messages[i].msg_hdr.msg_name = &_source_addresses[i].storage;
+        _messages[i].msg_hdr.msg_iov = &_iovecs[i];
+        _messages[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+string_view UDPSocket::received_batch::payload(const size_t i) const {
+    return {static_cast<const char *>(_iovecs.at(i).iov_base), _messages.at(i).msg_len};
+}
+
+Address UDPSocket::received_batch::source_address(const size_t i) const {
+    return {_source_addresses.at(i), _messages.at(i).msg_hdr.msg_namelen};
+}
+
+//! \param[in,out] batch receives the datagrams into its slots, replacing those of the last call
+//! \returns the number of datagrams received, which fill the first slots of `batch`
+//! \details One [recvmmsg(2)](\ref man2::recvmmsg) call, which blocks until a datagram arrives and then
+//! takes whichever others are already queued (MSG_WAITFORONE).
+size_t UDPSocket::recv_many(received_batch &batch) {
+    // the kernel shrinks msg_namelen to each source address's size
+    for (auto &message : batch._messages) {
+        message.msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+
+    batch._count = 0;
+    const int count = SystemCall(
+        "recvmmsg", ::recvmmsg(fd_num(), batch._messages.data(), batch._messages.size(), MSG_WAITFORONE, nullptr));
+
+    register_read();
+    for (int i = 0; i < count; i++) {
+        if (batch._messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            throw runtime_error("recvmmsg (oversized datagram)");
+        }
+    }
+    batch._count = count;
+    return count;
+}
+
 void sendmsg_helper(const int fd_num,
                     const sockaddr *destination_address,
                     const socklen_t destination_address_len,
@@ -136,6 +185,51 @@ void UDPSocket::sendto(const Address &destination, const BufferViewList &payload
     register_write();
 }
 
+//! \param[in] destination is the Address to send every datagram to
+//! \param[in] payloads are the datagram payloads, sent in order
+//! \param[in] segment_size is 0 to send each payload as one datagram, or else the length of the datagrams
+//! the kernel cuts each payload into (the last one may be shorter), with the UDP_SEGMENT option
+//! \details Calls [sendmmsg(2)](\ref man2::sendmmsg) until every payload has been sent.
+void UDPSocket::sendto_many(const Address &destination,
+                            const vector<BufferViewList> &payloads,
+                            const size_t segment_size) {
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint16_t))]{};
+    if (segment_size > 0) {
+        cmsghdr *cmsg = reinterpret_cast<cmsghdr *>(control);
+        cmsg->cmsg_level = IPPROTO_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        const uint16_t gso_size = segment_size;
+        memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+    }
+
+    vector<vector<iovec>> iovecs;
+    iovecs.reserve(payloads.size());
+    vector<mmsghdr> messages(payloads.size());
+    for (size_t i = 0; i < payloads.size(); i++) {
+        iovecs.push_back(payloads[i].as_iovecs());
+        messages[i].msg_hdr.msg_name = const_cast<sockaddr *>(static_cast<const sockaddr *>(destination));
+        messages[i].msg_hdr.msg_namelen = destination.size();
+        messages[i].msg_hdr.msg_iov = iovecs[i].data();
+        messages[i].msg_hdr.msg_iovlen = iovecs[i].size();
+        if (segment_size > 0) {
+            messages[i].msg_hdr.msg_control = static_cast<void *>(control);
+            messages[i].msg_hdr.msg_controllen = sizeof(control);
+        }
+    }
+
+    for (size_t sent = 0; sent < messages.size();) {
+        const int count =
+            SystemCall("sendmmsg", ::sendmmsg(fd_num(), messages.data() + sent, messages.size() - sent, 0));
+        register_write();
+        for (int i = 0; i < count; i++, sent++) {
+            if (messages[sent].msg_len != payloads[sent].size()) {
+                throw runtime_error("datagram payload too big for sendmmsg()");
+            }
+        }
+    }
+}
+
 void UDPSocket::send(const BufferViewList &payload) {
     sendmsg_helper(fd_num(), nullptr, 0, payload);
     register_write();
@@ -6,8 +6,12 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
 
 //! \brief Base class for network sockets (TCP, UDP, etc.)
 //! \details Socket is generally used via a subclass. See TCPSocket and UDPSocket for usage examples.
@@ -70,9 +74,52 @@ class UDPSocket : public Socket {
     //! Receive a datagram and the Address of its sender (caller can allocate storage)
     void recv(received_datagram &datagram, const size_t mtu = 65536);
 
+    //! \brief Filled by UDPSocket::recv_many; the caller keeps one so that its storage is set up once and reused
+    //! \details Each slot owns `mtu` bytes, allocated (but not initialized) up front, and its own source
+    //! address, iovec and mmsghdr. A payload stays valid until the next recv_many() into the same batch.
+    class received_batch {
+      private:
+        friend class UDPSocket;
+
+        std::unique_ptr<char[]> _storage;  //!< `mtu` bytes per slot
+        std::vector<Address::Raw> _source_addresses;
+        std::vector<iovec> _iovecs;
+        std::vector<mmsghdr> _messages;
+        size_t _count = 0;  //!< slots filled by the last recv_many()
+
+      public:
+        //! \param[in] slots is the most datagrams one recv_many() can return
+        //! \param[in] mtu is the largest datagram a slot can hold
+        explicit received_batch(const size_t slots, const size_t mtu = 65536);
+
+        //! The messages point into the batch's own arrays, so it may be moved but not copied
+        received_batch(const received_batch &other) = delete;
+        received_batch &operator=(const received_batch &other) = delete;
+        received_batch(received_batch &&other) = default;
+        received_batch &operator=(received_batch &&other) = default;
+        ~received_batch() = default;
+
+        //! \returns the number of datagrams the last recv_many() returned
+        size_t size() const { return _count; }
+
+        //! \returns the payload of the `i`th datagram
+        std::string_view payload(const size_t i) const;
+
+        //! \returns the Address from which the `i`th datagram was received
+        Address source_address(const size_t i) const;
+    };
+
+    //! Receive up to one batch of datagrams with one call, waiting only for the first
+    size_t recv_many(received_batch &batch);
+
     //! Send a datagram to specified Address
     void sendto(const Address &destination, const BufferViewList &payload);
 
+    //! Send datagrams to specified Address, many per call, optionally letting the kernel cut them up (UDP GSO)
+    void sendto_many(const Address &destination,
+                     const std::vector<BufferViewList> &payloads,
+                     const size_t segment_size = 0);
+
     //! Send datagram to the socket's connected address (must call connect() first)
     void send(const BufferViewList &payload);
 };
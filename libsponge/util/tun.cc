@@ -20,12 +20,21 @@ using namespace std;
 //!     ip tuntap add mode tun user `username` name `devname`
 //!
 //! as root before calling this function.
-
-TunTapFD::TunTapFD(const string &devname, const bool is_tun)
-    : FileDescriptor(SystemCall("open", open(CLONEDEV, O_RDWR))) {
+//!
+//! \param[in] vnet_hdr is `true` to exchange every packet with a virtio-net header in front of it
+//! (IFF_VNET_HDR), so that TCP checksums can be left for the kernel to complete or can be trusted
+//! when the kernel has already verified them. The header is little-endian (TUNSETVNETLE), and the
+//! kernel is told that it may hand over packets whose checksum is still partial (TUN_F_CSUM), and
+//! TCP super-segments of up to 64 KiB that it has not cut to the MTU (TUN_F_TSO4).
+
+TunTapFD::TunTapFD(const string &devname, const bool is_tun, const bool vnet_hdr)
+    : FileDescriptor(SystemCall("open", open(CLONEDEV, O_RDWR))), _vnet_hdr(vnet_hdr) {
     struct ifreq tun_req {};
 
     tun_req.ifr_flags = (is_tun ? IFF_TUN : IFF_TAP) | IFF_NO_PI;  // tun device with no packetinfo
+    if (vnet_hdr) {
+        tun_req.ifr_flags |= IFF_VNET_HDR;
+    }
 
     // copy devname to ifr_name, making sure to null terminate
 
@@ -33,4 +42,15 @@ TunTapFD::TunTapFD(const string &devname, const bool is_tun)
     tun_req.ifr_name[IFNAMSIZ - 1] = '\0';
 
     SystemCall("ioctl", ioctl(fd_num(), TUNSETIFF, static_cast<void *>(&tun_req)));
+
+    if (vnet_hdr) {
+        int hdr_size = 10;  // sizeof(struct virtio_net_hdr): <linux/virtio_net.h> does not compile as C++
+        SystemCall("ioctl", ioctl(fd_num(), TUNSETVNETHDRSZ, &hdr_size));
+        int little_endian = 1;
+        SystemCall("ioctl", ioctl(fd_num(), TUNSETVNETLE, &little_endian));
+    }
+    // the offloads outlive this file descriptor on a persistent device, so clear them when there is no
+    // virtio-net header to say that a checksum is still partial or that a packet is a super-segment
+    const unsigned long offloads = vnet_hdr ? TUN_F_CSUM | TUN_F_TSO4 : 0;
+    SystemCall("ioctl", ioctl(fd_num(), TUNSETOFFLOAD, offloads));
 }
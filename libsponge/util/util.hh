@@ -53,13 +53,35 @@ uint64_t timestamp_ms();
 
 //! The internet checksum algorithm
 class InternetChecksum {
+  public:
+    //! How add() sums the bytes: one at a time, 8 at a time, or 16 or 32 at a time with SIMD instructions
+    enum class Kernel { Scalar, Word64, SSE2, AVX2 };
+
+    //! The fastest kernel this CPU supports, chosen once at startup
+    static Kernel best_kernel();
+
+    //! \returns true if this CPU can run `kernel`
+    static bool supported(const Kernel kernel);
+
   private:
     uint32_t _sum;
     bool _parity{};
+    Kernel _kernel;
+
+    template <bool copy>
+    void add_span(char *dst, std::string_view data);
 
   public:
-    InternetChecksum(const uint32_t initial_sum = 0);
+    InternetChecksum(const uint32_t initial_sum = 0, const Kernel kernel = best_kernel());
     void add(std::string_view data);
+
+    //! Add `src` to the checksum while copying it to `dst`, in a single pass over the bytes
+    void add_copy(char *dst, std::string_view src);
+
+    //! Add a span of `length` bytes whose sum() was computed earlier, without touching its bytes again
+    void add_sum(const uint16_t sum, const size_t length);
+
+    uint16_t sum() const;
     uint16_t value() const;
 };
 
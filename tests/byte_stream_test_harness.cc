@@ -181,4 +181,17 @@ void Peek::execute(ByteStream &bs) const {
         throw ByteStreamExpectationViolation("Expected \"" + _output + "\" at the front of the stream, but found \"" +
                                              output + "\"");
     }
+
+    // the zero-copy views must expose exactly the same bytes
+    string from_views;
+    for (const auto &iov : bs.peek_output_views(_output.size()).as_iovecs()) {
+        if (iov.iov_len == 0 and not output.empty()) {
+            throw ByteStreamExpectationViolation("peek_output_views() returned an empty view");
+        }
+        from_views.append(static_cast<const char *>(iov.iov_base), iov.iov_len);
+    }
+    if (from_views != output) {
+        throw ByteStreamExpectationViolation("peek_output_views() returned \"" + from_views +
+                                             "\" but peek_output() returned \"" + output + "\"");
+    }
 }
@@ -124,6 +124,35 @@ int main() {
             test.execute(BufferSize{0});
         }
 
+        // with a capacity of 8 the ring has exactly 8 slots, so each write below lands in one span or in two
+        {
+            ByteStreamTestHarness test{"writes-that-wrap-the-ring", 8};
+
+            test.execute(Write{"abcdef"}.with_bytes_written(6));
+            test.execute(Peek{"abcdef"});
+            test.execute(Pop{5});
+
+            // slots 6-7, then 0-2
+            test.execute(Write{"ghijk"}.with_bytes_written(5));
+            test.execute(BufferSize{6});
+            test.execute(Peek{"fghijk"});
+            test.execute(Pop{6});
+
+            // slots 3-7, up to the end of the ring; then 0-2, from its start
+            test.execute(Write{"lmnop"}.with_bytes_written(5));
+            test.execute(Write{"qrs"}.with_bytes_written(3));
+            test.execute(RemainingCapacity{0});
+            test.execute(Peek{"lmnopqrs"});
+            test.execute(Write{"t"}.with_bytes_written(0));
+
+            // the bytes now sit in slots 7 and 0-2, so the free slots 3-6 are one span; the write is clipped to them
+            test.execute(Pop{4});
+            test.execute(Write{"tuvwxyz"}.with_bytes_written(4));
+            test.execute(Peek{"pqrstuvw"});
+            test.execute(BytesRead{15});
+            test.execute(BytesWritten{23});
+        }
+
     } catch (const exception &e) {
         cerr << "Exception: " << e.what() << endl;
         return EXIT_FAILURE;
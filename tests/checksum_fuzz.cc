@@ -0,0 +1,185 @@
+#include "byte_stream.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+#include "virtio_net_header.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+using Kernel = InternetChecksum::Kernel;
+
+static string kernel_name(const Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return "scalar";
+        case Kernel::Word64:
+            return "word64";
+        case Kernel::SSE2:
+            return "SSE2";
+        case Kernel::AVX2:
+            return "AVX2";
+    }
+    return "unknown";
+}
+
+// Checksum `data` in pieces cut at `splits`, so that most add() calls start at an odd offset
+static uint16_t checksum(const Kernel kernel, const uint32_t initial_sum, const string &data,
+                         const vector<size_t> &splits) {
+    InternetChecksum check{initial_sum, kernel};
+    size_t pos = 0;
+    for (const size_t split : splits) {
+        check.add(string_view{data}.substr(pos, split - pos));
+        pos = split;
+    }
+    check.add(string_view{data}.substr(pos));
+    return check.value();
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const vector<Kernel> kernels{Kernel::Word64, Kernel::SSE2, Kernel::AVX2};
+
+        for (unsigned i = 0; i < 20000; i++) {
+            // mostly short spans around the SIMD block sizes, sometimes long ones past a lane flush
+            const size_t len = i % 100 == 0 ? rd() % 1200000 : rd() % 200;
+            string data(len, 0);
+            const bool saturated = i % 7 == 0;
+            for (auto &c : data) {
+                c = saturated ? char(0xff) : char(rd());
+            }
+            vector<size_t> splits(len > 0 ? rd() % 5 : 0);
+            for (auto &split : splits) {
+                split = rd() % (len + 1);
+            }
+            sort(splits.begin(), splits.end());
+            const uint32_t initial_sum = i % 2 ? rd() % 0x40000 : 0;
+
+            // the scalar loop can overflow its 32-bit sum on long saturated input; the other kernels can't
+            const bool comparable = len < 60000;
+            const uint16_t expected = checksum(Kernel::Scalar, initial_sum, data, splits);
+            const uint16_t word64 = checksum(Kernel::Word64, initial_sum, data, splits);
+            if (comparable and word64 != expected) {
+                throw runtime_error("word64 checksum " + to_string(word64) + " != scalar checksum " +
+                                    to_string(expected) + " for " + to_string(len) + " bytes");
+            }
+            for (const Kernel kernel : kernels) {
+                if (not InternetChecksum::supported(kernel)) {
+                    continue;
+                }
+                const uint16_t actual = checksum(kernel, initial_sum, data, splits);
+                if (actual != word64) {
+                    throw runtime_error(kernel_name(kernel) + " checksum " + to_string(actual) +
+                                        " != word64 checksum " + to_string(word64) + " for " + to_string(len) +
+                                        " bytes");
+                }
+            }
+
+            // copying while summing, and combining sums of the pieces taken separately, agree with add()
+            InternetChecksum copied{initial_sum}, combined{initial_sum};
+            string copy(len, 0);
+            size_t pos = 0;
+            splits.push_back(len);
+            for (const size_t split : splits) {
+                const string_view piece = string_view{data}.substr(pos, split - pos);
+                copied.add_copy(copy.data() + pos, piece);
+                InternetChecksum alone;
+                alone.add(piece);
+                combined.add_sum(alone.sum(), piece.size());
+                pos = split;
+            }
+            if (copy != data) {
+                throw runtime_error("add_copy() did not copy " + to_string(len) + " bytes intact");
+            }
+            if (copied.value() != word64 or combined.value() != word64) {
+                throw runtime_error("add_copy() or add_sum() disagrees with add() for " + to_string(len) + " bytes");
+            }
+        }
+
+        // a copied payload carries its sum into TCPSegment::serialize(), which still produces a valid segment
+        {
+            ByteStream stream{4096};
+            string data(4096, 0);
+            for (auto &c : data) {
+                c = char(rd());
+            }
+            stream.write(data.substr(0, 3000));
+            stream.pop_output(3000);
+            stream.write(data);
+            const Buffer payload = stream.read_buffer(2001);
+            if (payload.str() != data.substr(0, 2001) or not payload.partial_checksum().has_value()) {
+                throw runtime_error("read_buffer() should copy the bytes across the wrap and keep their sum");
+            }
+            if (payload.substr(1).partial_checksum().has_value()) {
+                throw runtime_error("a slice of a Buffer should not keep the whole Buffer's sum");
+            }
+            TCPSegment seg;
+            seg.header().ack = true;
+            seg.payload() = payload;
+            TCPSegment parsed;
+            if (parsed.parse(seg.serialize(0x1234).concatenate(), 0x1234) != ParseResult::NoError or
+                parsed.payload().str() != payload.str()) {
+                throw runtime_error("segment serialized with a cached payload sum does not parse");
+            }
+        }
+
+        // a span checksummed in one call and one byte at a time agree
+        {
+            const string data{"\x45\x00\x00\x73\x00\x00\x40\x00\x40\x11\x00\x00\xc0\xa8\x00\x01\xc0\xa8\x00\xc7", 20};
+            InternetChecksum whole, bytes{0, Kernel::Scalar};
+            whole.add(data);
+            for (const char c : data) {
+                bytes.add({&c, 1});
+            }
+            if (whole.value() != 0xb861 or bytes.value() != 0xb861) {
+                throw runtime_error("IPv4 header checksum should be 0xb861");
+            }
+        }
+
+        // a partial checksum, completed the way the kernel does for a virtio-net FLAG_NEEDS_CSUM packet, is valid
+        {
+            TCPSegment seg;
+            seg.header().ack = true;
+            seg.header().win = 1234;
+            seg.payload() = Buffer{string(1001, 'y')};
+            const uint32_t pseudo = 0x1234;
+            string wire = seg.serialize(pseudo, true).concatenate();
+            VirtioNetHeader vnet;
+            vnet.flags = VirtioNetHeader::FLAG_NEEDS_CSUM;
+            vnet.csum_offset = TCPHeader::CHECKSUM_OFFSET;
+            NetParser p{vnet.serialize() + wire};
+            VirtioNetHeader parsed_vnet;
+            if (parsed_vnet.parse(p) != ParseResult::NoError or not parsed_vnet.checksum_trusted() or
+                parsed_vnet.csum_offset != TCPHeader::CHECKSUM_OFFSET) {
+                throw runtime_error("virtio-net header did not survive a round trip");
+            }
+            TCPSegment parsed;
+            if (parsed.parse(string(wire), pseudo) != ParseResult::BadChecksum or
+                parsed.parse(string(wire), pseudo, parsed_vnet.checksum_trusted()) != ParseResult::NoError) {
+                throw runtime_error("a partial checksum should only be accepted when it is trusted");
+            }
+            InternetChecksum kernel;
+            kernel.add(wire);
+            const uint16_t cksum = kernel.value();
+            wire[TCPHeader::CHECKSUM_OFFSET] = char(cksum >> 8);
+            wire[TCPHeader::CHECKSUM_OFFSET + 1] = char(cksum);
+            if (parsed.parse(string(wire), pseudo) != ParseResult::NoError) {
+                throw runtime_error("the completed partial checksum is wrong");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
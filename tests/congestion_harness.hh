@@ -0,0 +1,216 @@
+#ifndef SPONGE_CONGESTION_HARNESS_HH
+#define SPONGE_CONGESTION_HARNESS_HH
+
+#include "congestion_control.hh"
+#include "tcp_receiver.hh"
+#include "tcp_sender.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! A bulk-transfer flow: a TCPSender with an endless supply of bytes, and the TCPReceiver it talks to.
+class Host {
+    TCPSender _sender;
+    TCPReceiver _receiver;
+    uint64_t _start_ms;
+    bool _sack;
+    uint64_t _delivered = 0;
+
+  public:
+    Host(const TCPConfig &config, const uint64_t start_ms)
+        : _sender(config), _receiver(config.recv_capacity), _start_ms(start_ms), _sack(config.sack) {}
+
+    TCPSender &sender() { return _sender; }
+    TCPReceiver &receiver() { return _receiver; }
+    bool started(const uint64_t now_ms) const { return now_ms >= _start_ms; }
+    uint64_t delivered() const { return _delivered; }
+    bool sack() const { return _sack; }
+
+    //! keep the sender's stream full, and the receiver's stream empty
+    void pump() {
+        static const std::string data(TCPConfig::DEFAULT_CAPACITY, 'x');
+        _sender.stream_in().write_view({data.data(), _sender.stream_in().remaining_capacity()});
+        auto &inbound = _receiver.stream_out();
+        _delivered += inbound.buffer_size();
+        inbound.pop_output(inbound.buffer_size());
+    }
+};
+
+//! \brief Hosts sharing one bottleneck link, in 1 ms steps.
+//!
+//! Like the Network in apps/network_simulator.cc, but the link between the hosts
+//! has a rate, a drop-tail queue and a propagation delay. ACKs come back over an
+//! uncongested path with the same delay, and carry SACK blocks if the host's
+//! TCPConfig asks for them. Optionally the link
+//! also loses segments at random, independent of the queue.
+class BottleneckNetwork {
+    struct InFlight {
+        uint64_t arrival_ms;
+        size_t host;
+        TCPSegment segment;
+    };
+
+    struct Ack {
+        uint64_t arrival_ms;
+        size_t host;
+        WrappingInt32 ackno;
+        uint16_t window;
+        std::vector<std::pair<WrappingInt32, WrappingInt32>> sack;
+    };
+
+    size_t _rate;  //!< bytes the link serves per ms
+    size_t _queue_limit;
+    uint64_t _delay_ms;
+    uint16_t _rto;
+
+    std::vector<std::unique_ptr<Host>> _hosts{};
+    std::deque<InFlight> _queue{};
+    size_t _queued_bytes = 0;
+    size_t _credit = 0;
+    std::deque<InFlight> _link{};
+    std::deque<Ack> _acks{};
+    uint64_t _now_ms = 0;
+    uint64_t _dropped = 0;
+    uint64_t _lost = 0;
+    uint64_t _sent = 0;
+    double _loss_rate = 0;
+    std::mt19937 _rd{get_random_generator()};
+
+    void enqueue(const size_t host, TCPSegment &&segment) {
+        const size_t len = segment.length_in_sequence_space();
+        _sent++;
+        if (_loss_rate > 0 and std::bernoulli_distribution{_loss_rate}(_rd)) {
+            _lost++;
+            return;
+        }
+        if (_queued_bytes + len > _queue_limit) {
+            _dropped++;
+            return;
+        }
+        _queued_bytes += len;
+        _queue.push_back({0, host, std::move(segment)});
+    }
+
+    void serve() {
+        _credit += _rate;
+        while (not _queue.empty() and _queue.front().segment.length_in_sequence_space() <= _credit) {
+            InFlight packet = std::move(_queue.front());
+            _queue.pop_front();
+            const size_t len = packet.segment.length_in_sequence_space();
+            _credit -= len;
+            _queued_bytes -= len;
+            packet.arrival_ms = _now_ms + _delay_ms;
+            _link.push_back(std::move(packet));
+        }
+        if (_queue.empty()) {
+            _credit = std::min(_credit, _rate);
+        }
+    }
+
+    void deliver() {
+        while (not _link.empty() and _link.front().arrival_ms <= _now_ms) {
+            const InFlight &packet = _link.front();
+            Host &h = *_hosts.at(packet.host);
+            TCPReceiver &receiver = h.receiver();
+            receiver.segment_received(packet.segment);
+            const auto window = uint16_t(std::min(receiver.window_size(), size_t{UINT16_MAX}));
+            _acks.push_back({_now_ms + _delay_ms,
+                             packet.host,
+                             receiver.ackno().value(),
+                             window,
+                             h.sack() ? receiver.sack_blocks(4) : decltype(Ack::sack){}});
+            _link.pop_front();
+        }
+        while (not _acks.empty() and _acks.front().arrival_ms <= _now_ms) {
+            const Ack &ack = _acks.front();
+            _hosts.at(ack.host)->sender().ack_received(ack.ackno, ack.window, ack.sack);
+            _acks.pop_front();
+        }
+    }
+
+  public:
+    //! \param rate bytes per millisecond through the bottleneck
+    //! \param queue_limit bytes the bottleneck queue holds before dropping
+    //! \param delay_ms one-way propagation delay
+    //! \param rto initial retransmission timeout of every sender
+    BottleneckNetwork(const size_t rate, const size_t queue_limit, const uint64_t delay_ms, const uint16_t rto = 200)
+        : _rate(rate), _queue_limit(queue_limit), _delay_ms(delay_ms), _rto(rto) {}
+
+    //! \brief Drop this fraction of data segments at random before they reach the queue
+    BottleneckNetwork &with_loss(const double loss_rate) {
+        _loss_rate = loss_rate;
+        return *this;
+    }
+
+    //! \returns the index of the new host
+    size_t add_host(const TCPConfig &config, const uint64_t start_ms = 0) {
+        _hosts.push_back(std::make_unique<Host>(config, start_ms));
+        return _hosts.size() - 1;
+    }
+
+    //! \returns the index of the new host
+    size_t add_host(const CongestionControl::Algorithm algorithm, const uint64_t start_ms = 0) {
+        TCPConfig config;
+        config.rt_timeout = _rto;
+        config.congestion_control = algorithm;
+        config.sack = true;
+        return add_host(config, start_ms);
+    }
+
+    Host &host(const size_t index) { return *_hosts.at(index); }
+
+    void run(const uint64_t ms) {
+        for (const uint64_t end = _now_ms + ms; _now_ms < end; ++_now_ms) {
+            deliver();
+            for (size_t i = 0; i < _hosts.size(); i++) {
+                Host &h = *_hosts[i];
+                if (not h.started(_now_ms)) {
+                    continue;
+                }
+                h.pump();
+                h.sender().fill_window();
+                auto &out = h.sender().segments_out();
+                while (not out.empty()) {
+                    enqueue(i, std::move(out.front()));
+                    out.pop();
+                }
+                h.sender().tick(1);
+            }
+            serve();
+        }
+    }
+
+    //! \returns bytes each host has delivered so far
+    std::vector<uint64_t> delivered() const {
+        std::vector<uint64_t> ret;
+        for (const auto &h : _hosts) {
+            ret.push_back(h->delivered());
+        }
+        return ret;
+    }
+
+    uint64_t dropped() const { return _dropped; }
+    uint64_t lost() const { return _lost; }
+    uint64_t sent() const { return _sent; }
+    size_t rate() const { return _rate; }
+};
+
+//! Jain's fairness index: 1 when every share is equal, 1/n when one flow takes everything
+inline double jain_index(const std::vector<double> &shares) {
+    double sum = 0, sum_sq = 0;
+    for (const double x : shares) {
+        sum += x;
+        sum_sq += x * x;
+    }
+    return sum_sq == 0 ? 0 : sum * sum / (double(shares.size()) * sum_sq);
+}
+
+#endif  // SPONGE_CONGESTION_HARNESS_HH
@@ -0,0 +1,114 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        TCPConfig cfg{};
+        cfg.delayed_ack = true;
+        cfg.delayed_ack_timeout = 40;
+        auto rd = get_random_generator();
+        const string d(4000, 'x');
+
+        // every second in-order segment is ACKed at once
+        {
+            const WrappingInt32 rx_isn(rd()), tx_isn(rd());
+            TCPTestHarness test = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test.execute(ExpectNoSegment{}, "the first segment's ACK should be delayed");
+            test.send_data(rx_isn + 1001, tx_isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 2001).with_payload_size(0),
+                         "the second segment should be ACKed at once");
+            test.send_data(rx_isn + 2001, tx_isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test.execute(ExpectNoSegment{}, "the count should restart after an ACK");
+        }
+
+        // a lone segment is ACKed when the timer expires
+        {
+            const WrappingInt32 rx_isn(rd()), tx_isn(rd());
+            TCPTestHarness test = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cbegin() + 100);
+            test.execute(Tick(39));
+            test.execute(ExpectNoSegment{}, "the ACK was sent before the delay ran out");
+            test.execute(Tick(1));
+            test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 101).with_payload_size(0),
+                         "the delayed ACK was not sent when the timer expired");
+            test.execute(Tick(100));
+            test.execute(ExpectNoSegment{}, "the delayed ACK was sent twice");
+        }
+
+        // out-of-order data, the segment filling the hole, and a FIN are ACKed at once
+        {
+            const WrappingInt32 rx_isn(rd()), tx_isn(rd());
+            TCPTestHarness test = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test.send_data(rx_isn + 1001, tx_isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 1).with_payload_size(0),
+                         "out-of-order data should be ACKed at once");
+            test.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 2001).with_payload_size(0),
+                         "the segment filling a hole should be ACKed at once");
+            test.send_data(rx_isn + 2001, tx_isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test.execute(ExpectNoSegment{});
+            test.send_fin(rx_isn + 3001, tx_isn + 1);
+            test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 3002).with_payload_size(0),
+                         "a FIN should be ACKed at once");
+        }
+
+        // outgoing data carries the delayed ACK
+        {
+            const WrappingInt32 rx_isn(rd()), tx_isn(rd());
+            TCPTestHarness test = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cbegin() + 100);
+            test.execute(ExpectNoSegment{});
+            test.execute(Write{"hello"});
+            test.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 101).with_data("hello"));
+            test.execute(Tick(40));
+            test.execute(ExpectNoSegment{}, "the piggybacked ACK should cancel the delayed one");
+        }
+
+        // in a bulk transfer, the receiver sends about one ACK for every two data segments
+        {
+            TCPConnection client{cfg}, server{cfg};
+            size_t data_segments = 0, acks = 0, received = 0;
+            const size_t len = 1000000;
+            client.connect();
+            for (size_t written = 0; received < len;) {
+                if (written < len) {
+                    written += client.write(string(min(len - written, client.remaining_outbound_capacity()), 'x'));
+                }
+                for (; not client.segments_out().empty(); client.segments_out().pop()) {
+                    data_segments += client.segments_out().front().payload().size() > 0;
+                    server.segment_received(client.segments_out().front());
+                }
+                for (; not server.segments_out().empty(); server.segments_out().pop()) {
+                    acks++;
+                    client.segment_received(server.segments_out().front());
+                }
+                received += server.inbound_stream().buffer_size();
+                server.inbound_stream().pop_output(server.inbound_stream().buffer_size());
+                client.tick(1);
+                server.tick(1);
+            }
+            if (2 * acks > data_segments + 100) {
+                throw runtime_error("receiver sent " + to_string(acks) + " ACKs for " + to_string(data_segments) +
+                                    " data segments");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -164,8 +164,10 @@ class ReassemblerTestHarness {
     std::vector<std::string> steps_executed;
 
   public:
-    ReassemblerTestHarness(const size_t capacity) : reassembler(capacity), steps_executed() {
-        steps_executed.emplace_back("Initialized (capacity = " + std::to_string(capacity) + ")");
+    ReassemblerTestHarness(const size_t capacity, const StreamReassembler::Mode mode = StreamReassembler::Mode::Map)
+        : reassembler(capacity, ByteStream::Storage::Ring, mode), steps_executed() {
+        steps_executed.emplace_back("Initialized (capacity = " + std::to_string(capacity) + ", mode = " +
+                                    (mode == StreamReassembler::Mode::Map ? "Map" : "Window") + ")");
     }
 
     void execute(const ReassemblerTestStep &step) {
@@ -0,0 +1,66 @@
+#include "byte_stream.hh"
+#include "fsm_stream_reassembler_harness.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+// A substring that starts at the first unassembled byte while nothing is held is written straight
+// through to the stream. Mix such writes with out-of-order ones and with ones past the capacity.
+int main() {
+    try {
+        for (const auto mode : {StreamReassembler::Mode::Map, StreamReassembler::Mode::Window}) {
+            ReassemblerTestHarness test{8, mode};
+
+            // straight through
+            test.execute(SubmitSegment{"abc", 0});
+            test.execute(BytesAssembled(3));
+            test.execute(UnassembledBytes(0));
+
+            // held, and clipped to the 5 bytes of room left
+            test.execute(SubmitSegment{"ghi", 6});
+            test.execute(BytesAssembled(3));
+            test.execute(UnassembledBytes(2));
+
+            // in order, but something is held: merged, not written straight through
+            test.execute(SubmitSegment{"def", 3});
+            test.execute(BytesAssembled(8));
+            test.execute(UnassembledBytes(0));
+            test.execute(BytesAvailable("abcdefgh"));
+
+            // straight through again, cut at the capacity
+            test.execute(SubmitSegment{"ijklmnopqrst", 8});
+            test.execute(BytesAssembled(16));
+            test.execute(UnassembledBytes(0));
+            test.execute(BytesAvailable("ijklmnop"));
+
+            // overlaps what is already assembled, so only the new part is written
+            test.execute(SubmitSegment{"pqr", 15});
+            test.execute(BytesAssembled(18));
+
+            test.execute(SubmitSegment{"uv", 20});
+            test.execute(UnassembledBytes(2));
+            test.execute(SubmitSegment{"st", 18});
+            test.execute(BytesAssembled(22));
+            test.execute(UnassembledBytes(0));
+
+            // nothing held and 2 bytes of room: the write stops short of the EOF
+            test.execute(SubmitSegment{"wxyz", 22}.with_eof(true));
+            test.execute(BytesAssembled(24));
+            test.execute(NotAtEof{});
+            test.execute(BytesAvailable("qrstuvwx"));
+            test.execute(SubmitSegment{"yz", 24}.with_eof(true));
+            test.execute(BytesAssembled(26));
+            test.execute(BytesAvailable("yz"));
+            test.execute(AtEof{});
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
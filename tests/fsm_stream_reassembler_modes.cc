@@ -0,0 +1,77 @@
+#include "byte_stream.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+static constexpr unsigned NREPS = 64;
+static constexpr unsigned NSEGS = 256;
+static constexpr unsigned MAX_SEG_LEN = 512;
+
+// Push the same random, overlapping, partly out-of-window substrings into a
+// Mode::Map and a Mode::Window reassembler and check that they always agree.
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            const size_t capacity = 1 + rd() % (4 * MAX_SEG_LEN);
+            const size_t total = 1 + rd() % (NSEGS * MAX_SEG_LEN / 4);
+            string d(total, 0);
+            generate(d.begin(), d.end(), [&] { return rd(); });
+
+            StreamReassembler map_buf{capacity, ByteStream::Storage::Ring, StreamReassembler::Mode::Map};
+            StreamReassembler win_buf{capacity, ByteStream::Storage::Ring, StreamReassembler::Mode::Window};
+            string map_out, win_out;
+
+            for (unsigned i = 0; i < NSEGS * 4 && not map_buf.stream_out().eof(); ++i) {
+                // favour substrings near the reader so that most of them land in the window
+                const size_t near = map_out.size() + rd() % (2 * capacity);
+                const size_t off = min(near, total - 1);
+                const size_t sz = min<size_t>(1 + rd() % MAX_SEG_LEN, total - off);
+                const bool eof = off + sz == total;
+
+                map_buf.push_substring(d.substr(off, sz), off, eof);
+                win_buf.push_substring(d.substr(off, sz), off, eof);
+
+                if (map_buf.unassembled_bytes() != win_buf.unassembled_bytes()) {
+                    throw runtime_error("unassembled_bytes() differs: " + to_string(map_buf.unassembled_bytes()) +
+                                        " vs " + to_string(win_buf.unassembled_bytes()));
+                }
+                if (map_buf.stream_out().buffer_size() != win_buf.stream_out().buffer_size()) {
+                    throw runtime_error("stream_out().buffer_size() differs");
+                }
+                if (map_buf.stream_out().input_ended() != win_buf.stream_out().input_ended()) {
+                    throw runtime_error("stream_out().input_ended() differs");
+                }
+
+                // drain some of the output so that the window slides (and the ring wraps)
+                const size_t to_read = rd() % (map_buf.stream_out().buffer_size() + 1);
+                map_out.append(map_buf.stream_out().read(to_read));
+                win_out.append(win_buf.stream_out().read(to_read));
+                if (map_out != win_out) {
+                    throw runtime_error("reassembled bytes differ");
+                }
+            }
+
+            if (map_out != d.substr(0, map_out.size())) {
+                throw runtime_error("reassembled bytes are incorrect");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+#include "tcp_config.hh"
+#include "tcp_connection.hh"
+#include "tcp_header.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Moves every segment `from` has queued into `to`, and returns the last one.
+static optional<TCPSegment> deliver(TCPConnection &from, TCPConnection &to) {
+    optional<TCPSegment> last;
+    while (not from.segments_out().empty()) {
+        last = from.segments_out().front();
+        to.segment_received(from.segments_out().front());
+        from.segments_out().pop();
+    }
+    return last;
+}
+
+int main() {
+    try {
+        // the option survives a serialize/parse round trip
+        {
+            TCPHeader h;
+            h.syn = true;
+            h.window_scale = 7;
+            h.fit_doff();
+            TCPHeader parsed;
+            NetParser p{h.serialize()};
+            if (h.doff != 6 or parsed.parse(p) != ParseResult::NoError or parsed.window_scale != h.window_scale) {
+                throw runtime_error("window scale changed across a round trip: " + parsed.summary());
+            }
+        }
+
+        // 1 MB of receive capacity needs a shift of 4; SYNs carry unscaled windows, later segments scaled ones
+        {
+            TCPConfig cfg;
+            cfg.window_scaling = true;
+            cfg.recv_capacity = 1000000;
+            cfg.send_capacity = 1024 * 1024;
+            TCPConnection client{cfg}, server{cfg};
+            client.connect();
+            const auto syn = deliver(client, server);
+            if (not syn.has_value() or syn->header().window_scale != 4 or syn->header().win != UINT16_MAX) {
+                throw runtime_error("SYN should offer a shift of 4 with an unscaled window: " +
+                                    syn->header().summary());
+            }
+            const auto syn_ack = deliver(server, client);
+            if (not syn_ack.has_value() or syn_ack->header().window_scale != 4 or syn_ack->header().win != UINT16_MAX) {
+                throw runtime_error("SYN/ACK should accept with an unscaled window: " + syn_ack->header().summary());
+            }
+            const auto ack = deliver(client, server);
+            if (not ack.has_value() or ack->header().window_scale.has_value() or
+                ack->header().win != cfg.recv_capacity >> 4) {
+                throw runtime_error("ACK should carry a window scaled by 4: " + ack->header().summary());
+            }
+
+            // the SYN/ACK's window is unscaled, so the first flight stops at 64 KiB...
+            client.write(string(200000, 'x'));
+            if (client.bytes_in_flight() != UINT16_MAX) {
+                throw runtime_error("sender used " + to_string(client.bytes_in_flight()) +
+                                    " bytes of the SYN/ACK's window, instead of 65535");
+            }
+            // ...and the first scaled window lets the rest go out at once
+            deliver(client, server);
+            const auto data_ack = deliver(server, client);
+            if (not data_ack.has_value() or data_ack->header().win != (cfg.recv_capacity - UINT16_MAX) >> 4) {
+                throw runtime_error("window should shrink by what the server holds: " + data_ack->header().summary());
+            }
+            if (client.bytes_in_flight() != 200000 - UINT16_MAX) {
+                throw runtime_error("sender has " + to_string(client.bytes_in_flight()) +
+                                    " bytes in flight, instead of " + to_string(200000 - UINT16_MAX));
+            }
+        }
+
+        // without the peer's agreement, windows stay unscaled and clamped
+        {
+            TCPConfig cfg;
+            cfg.window_scaling = true;
+            cfg.recv_capacity = 1000000;
+            cfg.send_capacity = 1024 * 1024;
+            TCPConfig plain;
+            plain.recv_capacity = 1000000;
+            TCPConnection client{cfg}, server{plain};
+            client.connect();
+            deliver(client, server);
+            const auto syn_ack = deliver(server, client);
+            const auto ack = deliver(client, server);
+            if (not syn_ack.has_value() or syn_ack->header().window_scale.has_value() or not ack.has_value() or
+                ack->header().win != UINT16_MAX) {
+                throw runtime_error("window scaling was used without being negotiated");
+            }
+            client.write(string(200000, 'x'));
+            if (client.bytes_in_flight() != UINT16_MAX) {
+                throw runtime_error("sender used " + to_string(client.bytes_in_flight()) + " bytes of a 64 KiB window");
+            }
+        }
+
+        // SACK-permitted is negotiated the same way: a SYN/ACK only carries it if the SYN offered it
+        {
+            TCPConfig cfg;
+            cfg.sack = true;
+            TCPConnection client{TCPConfig{}}, server{cfg};
+            client.connect();
+            deliver(client, server);
+            const auto syn_ack = deliver(server, client);
+            if (not syn_ack.has_value() or syn_ack->header().sack_permitted) {
+                throw runtime_error("SYN/ACK offered SACK to a peer that did not: " + syn_ack->header().summary());
+            }
+            TCPConnection sack_client{cfg}, sack_server{cfg};
+            sack_client.connect();
+            deliver(sack_client, sack_server);
+            const auto sack_syn_ack = deliver(sack_server, sack_client);
+            if (not sack_syn_ack.has_value() or not sack_syn_ack->header().sack_permitted) {
+                throw runtime_error("SYN/ACK should accept SACK: " + sack_syn_ack->header().summary());
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -88,6 +88,29 @@ int main() {
             test_1.execute(ExpectBytesInFlight{0}, "test 1 failed: after acking, bytes still in flight?");
             test_err_if(!equal(d.cbegin(), d.cend(), d_out.cbegin()), "test 1 failed: data mismatch");
         }
+
+        // test 2: a segment fills the window -> reading a little sends nothing -> reading the rest updates the window
+        {
+            TCPConfig cfg_2{};
+            cfg_2.recv_capacity = 4000;
+            const WrappingInt32 rx_isn(rd()), tx_isn(rd());
+            TCPTestHarness test_2 = TCPTestHarness::in_established(cfg_2, tx_isn, rx_isn);
+            const string d(4000, 'x');
+            test_2.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cend());
+            test_2.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 4001).with_win(0),
+                           "test 2 failed: a full receive buffer should close the window");
+
+            test_2._fsm.inbound_stream().pop_output(500);
+            test_2.execute(UpdateWindow{});
+            test_2.execute(ExpectNoSegment{}, "test 2 failed: window update for less than an MSS");
+
+            test_2._fsm.inbound_stream().pop_output(3500);
+            test_2.execute(UpdateWindow{});
+            test_2.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 4001).with_win(4000),
+                           "test 2 failed: no window update after the buffer was read");
+            test_2.execute(UpdateWindow{});
+            test_2.execute(ExpectNoSegment{}, "test 2 failed: window update sent twice");
+        }
     } catch (const exception &e) {
         cerr << e.what() << endl;
         return err_num;
@@ -13,6 +13,8 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 struct ReceiverTestStep {
     virtual std::string to_string() const { return "ReceiverTestStep"; }
@@ -84,6 +86,54 @@ struct ExpectWindow : public ReceiverExpectation {
     }
 };
 
+struct ExpectSackBlocks : public ReceiverExpectation {
+    std::vector<std::pair<WrappingInt32, WrappingInt32>> _blocks;
+    size_t _max_blocks;
+
+    ExpectSackBlocks(const std::vector<std::pair<WrappingInt32, WrappingInt32>> &blocks, const size_t max_blocks = 4)
+        : _blocks(blocks), _max_blocks(max_blocks) {}
+
+    static std::string to_string(const std::vector<std::pair<WrappingInt32, WrappingInt32>> &blocks) {
+        std::ostringstream ss;
+        ss << "[";
+        for (const auto &[left, right] : blocks) {
+            ss << " " << left << "-" << right;
+        }
+        ss << " ]";
+        return ss.str();
+    }
+
+    std::string description() const { return "sack blocks " + to_string(_blocks); }
+
+    void execute(TCPReceiver &receiver) const {
+        const auto blocks = receiver.sack_blocks(_max_blocks);
+        if (blocks != _blocks) {
+            throw ReceiverExpectationViolation("The TCPReceiver reported sack blocks " + to_string(blocks) +
+                                               ", but they were expected to be " + to_string(_blocks));
+        }
+    }
+};
+
+struct ExpectTsRecent : public ReceiverExpectation {
+    std::optional<uint32_t> _ts_recent;
+
+    ExpectTsRecent(const std::optional<uint32_t> ts_recent) : _ts_recent(ts_recent) {}
+
+    static std::string to_string(const std::optional<uint32_t> ts) {
+        return ts.has_value() ? std::to_string(ts.value()) : "none";
+    }
+
+    std::string description() const { return "TS.Recent " + to_string(_ts_recent); }
+
+    void execute(TCPReceiver &receiver) const {
+        if (receiver.ts_recent() != _ts_recent) {
+            throw ReceiverExpectationViolation("The TCPReceiver reported TS.Recent " +
+                                               to_string(receiver.ts_recent()) + ", but it was expected to be " +
+                                               to_string(_ts_recent));
+        }
+    }
+};
+
 struct ExpectUnassembledBytes : public ReceiverExpectation {
     size_t _n_bytes;
 
@@ -196,7 +246,9 @@ struct SegmentArrives : public ReceiverAction {
     WrappingInt32 ackno{0};
     uint16_t win{};
     std::string data{};
+    std::optional<std::pair<uint32_t, uint32_t>> timestamps{};
     std::optional<Result> result{};
+    std::optional<bool> accepted{};
 
     SegmentArrives &with_ack(WrappingInt32 ackno_) {
         ack = true;
@@ -238,6 +290,17 @@ struct SegmentArrives : public ReceiverAction {
         return *this;
     }
 
+    SegmentArrives &with_timestamps(uint32_t tsval, uint32_t tsecr = 0) {
+        timestamps.emplace(tsval, tsecr);
+        return *this;
+    }
+
+    //! expect segment_received() to accept the segment (or drop it, by PAWS)
+    SegmentArrives &with_accepted(bool accepted_) {
+        accepted = accepted_;
+        return *this;
+    }
+
     SegmentArrives &with_result(Result result_) {
         result = result_;
         return *this;
@@ -253,6 +316,7 @@ struct SegmentArrives : public ReceiverAction {
         seg.header().ackno = ackno;
         seg.header().seqno = seqno;
         seg.header().win = win;
+        seg.header().timestamps = timestamps;
         return seg;
     }
 
@@ -275,7 +339,13 @@ struct SegmentArrives : public ReceiverAction {
             o << " with data \"" << data << "\"";
         }
 
-        receiver.segment_received(std::move(seg));
+        const bool was_accepted = receiver.segment_received(std::move(seg));
+        if (accepted.has_value() and accepted.value() != was_accepted) {
+            throw ReceiverExpectationViolation(std::string("TCPReceiver::segment_received() ") +
+                                               (was_accepted ? "accepted" : "dropped") + " `" + o.str() +
+                                               "`, but it was expected to " + (accepted.value() ? "accept" : "drop") +
+                                               " it");
+        }
 
         Result res;
 
@@ -298,10 +368,14 @@ class TCPReceiverTestHarness {
     std::vector<std::string> steps_executed;
 
   public:
-    TCPReceiverTestHarness(size_t capacity) : receiver(capacity), steps_executed() {
+    TCPReceiverTestHarness(size_t capacity,
+                           StreamReassembler::Mode mode = StreamReassembler::Mode::Map,
+                           bool timestamps = false)
+        : receiver(capacity, ByteStream::Storage::Ring, mode, timestamps), steps_executed() {
         std::ostringstream ss;
         ss << "Initialized with ("
-           << "capacity=" << capacity << ")";
+           << "capacity=" << capacity << (mode == StreamReassembler::Mode::Window ? ", window reassembler" : "")
+           << (timestamps ? ", timestamps" : "") << ")";
         steps_executed.emplace_back(ss.str());
     }
     void execute(const ReceiverTestStep &step) {
@@ -0,0 +1,94 @@
+#include "receiver_harness.hh"
+#include "tcp_header.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // SACK options survive a serialize/parse round trip, and are dropped if `doff` leaves no room
+        {
+            TCPHeader h;
+            h.syn = true;
+            h.sack_permitted = true;
+            h.sack = {{WrappingInt32{100}, WrappingInt32{200}}, {WrappingInt32{300}, WrappingInt32{400}}};
+            h.fit_doff();
+            if (h.doff != 11) {
+                throw runtime_error("fit_doff() gave doff " + to_string(h.doff) + " instead of 11");
+            }
+            TCPHeader parsed;
+            NetParser p{h.serialize()};
+            if (parsed.parse(p) != ParseResult::NoError) {
+                throw runtime_error("could not parse a header with SACK options");
+            }
+            if (not parsed.sack_permitted or parsed.sack != h.sack) {
+                throw runtime_error("SACK options changed across a round trip: " + parsed.summary());
+            }
+
+            h.doff = 5;
+            NetParser p2{h.serialize()};
+            if (parsed.parse(p2) != ParseResult::NoError or parsed.sack_permitted or not parsed.sack.empty()) {
+                throw runtime_error("options should be dropped when doff = 5");
+            }
+        }
+
+        for (const auto mode : {StreamReassembler::Mode::Map, StreamReassembler::Mode::Window}) {
+            // no blocks before the SYN or without holes
+            {
+                uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+                TCPReceiverTestHarness test{4000, mode};
+                test.execute(ExpectSackBlocks{{}});
+                test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+                test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+                test.execute(ExpectSackBlocks{{}});
+            }
+
+            // holes are reported, most recent first, and disappear when filled
+            {
+                uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+                TCPReceiverTestHarness test{4000, mode};
+                test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+                test.execute(SegmentArrives{}.with_seqno(isn + 11).with_data("klmn"));
+                test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 11}, WrappingInt32{isn + 15}}}});
+                test.execute(SegmentArrives{}.with_seqno(isn + 21).with_data("uvwx"));
+                test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 21}, WrappingInt32{isn + 25}},
+                                               {WrappingInt32{isn + 11}, WrappingInt32{isn + 15}}}});
+                test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("ef"));
+                test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 5}, WrappingInt32{isn + 7}},
+                                               {WrappingInt32{isn + 11}, WrappingInt32{isn + 15}},
+                                               {WrappingInt32{isn + 21}, WrappingInt32{isn + 25}}}});
+                test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 5}, WrappingInt32{isn + 7}}}, 1});
+
+                // joining two held ranges
+                test.execute(SegmentArrives{}.with_seqno(isn + 15).with_data("opqrst"));
+                test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 11}, WrappingInt32{isn + 25}},
+                                               {WrappingInt32{isn + 5}, WrappingInt32{isn + 7}}}});
+
+                // filling the first hole
+                test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd"));
+                test.execute(ExpectAckno{WrappingInt32{isn + 7}});
+                test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 11}, WrappingInt32{isn + 25}}}});
+                test.execute(SegmentArrives{}.with_seqno(isn + 7).with_data("ghij"));
+                test.execute(ExpectAckno{WrappingInt32{isn + 25}});
+                test.execute(ExpectSackBlocks{{}});
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
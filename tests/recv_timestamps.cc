@@ -0,0 +1,149 @@
+#include "receiver_harness.hh"
+#include "tcp_connection.hh"
+#include "tcp_header.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Moves every segment `from` has queued into `to`, and returns the last one.
+static optional<TCPSegment> deliver(TCPConnection &from, TCPConnection &to) {
+    optional<TCPSegment> last;
+    while (not from.segments_out().empty()) {
+        last = from.segments_out().front();
+        to.segment_received(from.segments_out().front());
+        from.segments_out().pop();
+    }
+    return last;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // the timestamps option survives a serialize/parse round trip, next to SACK blocks
+        {
+            TCPHeader h;
+            h.ack = true;
+            h.timestamps.emplace(0xdeadbeef, 12345);
+            h.sack = {{WrappingInt32{100}, WrappingInt32{200}}};
+            h.fit_doff();
+            if (h.doff != 11) {
+                throw runtime_error("fit_doff() gave doff " + to_string(h.doff) + " instead of 11");
+            }
+            TCPHeader parsed;
+            NetParser p{h.serialize()};
+            if (parsed.parse(p) != ParseResult::NoError) {
+                throw runtime_error("could not parse a header with timestamps");
+            }
+            if (parsed.timestamps != h.timestamps or parsed.sack != h.sack) {
+                throw runtime_error("options changed across a round trip: " + parsed.summary());
+            }
+
+            // with room for only one option, timestamps win over SACK
+            h.doff = 8;
+            NetParser p2{h.serialize()};
+            if (parsed.parse(p2) != ParseResult::NoError or parsed.timestamps != h.timestamps or
+                not parsed.sack.empty()) {
+                throw runtime_error("timestamps should fit in doff = 8, without the SACK block");
+            }
+        }
+
+        // no TS.Recent unless both sides offer timestamps
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_timestamps(100));
+            test.execute(ExpectTsRecent{nullopt});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_timestamps(50));
+            test.execute(ExpectBytes{"abcd"});
+        }
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000, StreamReassembler::Mode::Map, true};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+            test.execute(ExpectTsRecent{nullopt});
+        }
+
+        // TS.Recent follows in-order segments only; older timestamps are dropped (PAWS)
+        for (const auto mode : {StreamReassembler::Mode::Map, StreamReassembler::Mode::Window}) {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000, mode, true};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_timestamps(UINT32_MAX - 10));
+            test.execute(ExpectTsRecent{UINT32_MAX - 10});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abcd").with_timestamps(5).with_accepted(true));
+            test.execute(ExpectTsRecent{5});
+            test.execute(ExpectBytes{"abcd"});
+
+            // out of order: held, but the echo stays with the segment the ACK is for
+            test.execute(SegmentArrives{}.with_seqno(isn + 9).with_data("ijkl").with_timestamps(20));
+            test.execute(ExpectTsRecent{5});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("efgh").with_timestamps(30));
+            test.execute(ExpectTsRecent{30});
+            test.execute(ExpectBytes{"efghijkl"});
+
+            // an old duplicate from before a wrap of the sequence space
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 13).with_data("XXXX").with_timestamps(29).with_accepted(false));
+            test.execute(ExpectAckno{WrappingInt32{isn + 13}});
+            test.execute(ExpectTsRecent{30});
+            test.execute(
+                SegmentArrives{}.with_seqno(isn + 13).with_data("mnop").with_timestamps(30).with_accepted(true));
+            test.execute(ExpectBytes{"mnop"});
+
+            // segments without the option are not checked
+            test.execute(SegmentArrives{}.with_seqno(isn + 17).with_data("qrst"));
+            test.execute(ExpectBytes{"qrst"});
+        }
+
+        // connections negotiate on the SYN, and echo each other's clocks
+        {
+            TCPConfig cfg;
+            cfg.timestamps = true;
+            TCPConnection client{cfg}, server{cfg};
+            client.connect();
+            server.tick(7);
+            const auto syn = deliver(client, server);
+            if (not syn.has_value() or not syn->header().timestamps.has_value()) {
+                throw runtime_error("SYN did not offer timestamps");
+            }
+            const auto syn_ack = deliver(server, client);
+            if (not syn_ack.has_value() or syn_ack->header().timestamps != make_pair(uint32_t{8}, uint32_t{1})) {
+                throw runtime_error("SYN/ACK did not echo the client's timestamp: " + syn_ack->header().summary());
+            }
+            client.tick(3);
+            client.write("hello");
+            const auto data = deliver(client, server);
+            if (not data.has_value() or data->header().timestamps != make_pair(uint32_t{4}, uint32_t{8})) {
+                throw runtime_error("data segment did not carry timestamps: " + data->header().summary());
+            }
+
+            TCPConfig plain;
+            TCPConnection other{plain};
+            TCPConnection offering{cfg};
+            offering.connect();
+            deliver(offering, other);
+            const auto reply = deliver(other, offering);
+            offering.write("hello");
+            const auto after = deliver(offering, other);
+            if (not reply.has_value() or reply->header().timestamps.has_value() or not after.has_value() or
+                after->header().timestamps.has_value()) {
+                throw runtime_error("timestamps were sent without being negotiated");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include "sender_harness.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.coalescing = TCPConfig::Coalescing::Nagle;
+
+            TCPSenderTestHarness test{"Nagle: small writes wait while data is unacknowledged", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(5000));
+            test.execute(WriteBytes("a"));
+            test.execute(ExpectSegment{}.with_data("a").with_seqno(isn + 1));
+            test.execute(WriteBytes("b"));
+            test.execute(WriteBytes("c"));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_win(5000));
+            test.execute(ExpectSegment{}.with_data("bc").with_seqno(isn + 2));
+
+            // a full segment is never held, but what is left over after it is
+            test.execute(WriteBytes(string(1500, 'x')));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1004}}.with_win(5000));
+            test.execute(ExpectSegment{}.with_payload_size(500).with_seqno(isn + 1004));
+
+            // the last bytes before a FIN go out with it
+            test.execute(WriteBytes("d").with_end_input(true));
+            test.execute(ExpectSegment{}.with_data("d").with_fin(true));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.coalescing = TCPConfig::Coalescing::Cork;
+            cfg.cork_timeout = 50;
+
+            TCPSenderTestHarness test{"Cork: small writes wait for a full segment, or for cork_timeout", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(5000));
+            test.execute(WriteBytes("abc"));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{30});
+            test.execute(WriteBytes("def"));
+            test.execute(Tick{19});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("abcdef").with_seqno(isn + 1));
+
+            for (int i = 0; i < 10; i++) {
+                test.execute(WriteBytes(string(100, 'x')));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 7));
+            test.execute(ExpectNoSegment{});
+
+            // flush() sends at once, and only what was written before it
+            test.execute(WriteBytes("ghi"));
+            test.execute(Flush{});
+            test.execute(ExpectSegment{}.with_data("ghi").with_seqno(isn + 1007));
+            test.execute(WriteBytes("jkl"));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{50});
+            test.execute(ExpectSegment{}.with_data("jkl").with_seqno(isn + 1010));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"Without coalescing, every write is sent at once", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(5000));
+            test.execute(WriteBytes("a"));
+            test.execute(ExpectSegment{}.with_data("a"));
+            test.execute(WriteBytes("b"));
+            test.execute(ExpectSegment{}.with_data("b"));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+#include "congestion_harness.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "wrapping_integers.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+struct Result {
+    double utilization;
+    double fairness;
+    uint64_t dropped;
+};
+
+// 1 MB/s bottleneck (1 segment per ms), 20 ms RTT, a queue of one bandwidth-delay product.
+// Hosts start 500 ms apart; shares are measured over the last 8 seconds of a 10 second run.
+static Result share_bottleneck(const CongestionControl::Algorithm algorithm, const size_t hosts) {
+    const size_t rate = 1000;
+    BottleneckNetwork net{rate, 20 * rate, 10};
+    for (size_t i = 0; i < hosts; i++) {
+        net.add_host(algorithm, 500 * i);
+    }
+    net.run(2000);
+    const vector<uint64_t> before = net.delivered();
+    const uint64_t measured_ms = 8000;
+    net.run(measured_ms);
+    const vector<uint64_t> after = net.delivered();
+
+    vector<double> shares;
+    double total = 0;
+    for (size_t i = 0; i < hosts; i++) {
+        shares.push_back(double(after[i] - before[i]));
+        total += shares.back();
+    }
+    return {total / double(rate * measured_ms), jain_index(shares), net.dropped()};
+}
+
+// One SACK reveals that 6 of 16 segments were lost. The window the algorithm chose on the loss then decides
+// how many holes go out at a time: lowest first, as ACKs free up room, and no new data until all are resent.
+static void recover_holes(const CongestionControl::Algorithm algorithm, const string &name) {
+    TCPConfig cfg;
+    cfg.congestion_control = algorithm;
+    cfg.mss = 100;
+    TCPSender sender{cfg};
+    sender.fill_window();
+    sender.segments_out().pop();
+    sender.ack_received(sender.next_seqno(), 60000);
+    sender.stream_in().write(string(10000, 'x'));
+    sender.fill_window();
+    // slow start, one ACK per segment, until 16 segments are in flight
+    while (sender.cwnd() < 1600) {
+        const TCPSegment seg = sender.segments_out().front();
+        sender.segments_out().pop();
+        sender.ack_received(seg.header().seqno + seg.length_in_sequence_space(), 60000);
+    }
+    vector<WrappingInt32> flight;
+    for (; not sender.segments_out().empty(); sender.segments_out().pop()) {
+        flight.push_back(sender.segments_out().front().header().seqno);
+    }
+    if (flight.size() != 16) {
+        throw runtime_error(name + ": slow start left " + to_string(flight.size()) + " segments in flight, not 16");
+    }
+    const WrappingInt32 new_data = sender.next_seqno();
+
+    // segments 0-5 are lost, 6-8 arrive, 9-15 are on their way: 700 bytes still in the network
+    const vector<pair<WrappingInt32, WrappingInt32>> sack{{flight[6], flight[9]}};
+    sender.ack_received(flight[0], 60000, sack);
+    const size_t cwnd = sender.cwnd();
+    const size_t allowed = min<size_t>(6, (cwnd - 700 + 99) / 100);
+    size_t resent = 0;
+    for (; not sender.segments_out().empty(); sender.segments_out().pop(), resent++) {
+        if (resent >= 6 or sender.segments_out().front().header().seqno != flight[resent]) {
+            throw runtime_error(name + ": expected the holes, lowest first");
+        }
+    }
+    if (resent != allowed) {
+        throw runtime_error(name + ": a cwnd of " + to_string(cwnd) + " bytes let " + to_string(resent) +
+                            " holes out instead of " + to_string(allowed));
+    }
+
+    // each resent hole that is acked makes room for the next, and new data waits for the last
+    for (size_t acked = 1; resent < 6; acked++) {
+        sender.ack_received(flight[acked], 60000, sack);
+        for (; not sender.segments_out().empty(); sender.segments_out().pop(), resent++) {
+            const WrappingInt32 seqno = sender.segments_out().front().header().seqno;
+            if (seqno == new_data) {
+                throw runtime_error(name + ": new data was sent with " + to_string(6 - resent) + " holes left");
+            }
+            if (resent >= 6 or seqno != flight[resent]) {
+                throw runtime_error(name + ": expected the holes, lowest first");
+            }
+        }
+        if (acked >= resent) {
+            throw runtime_error(name + ": an ACK for a resent hole released nothing");
+        }
+    }
+}
+
+int main() {
+    try {
+        recover_holes(CongestionControl::Algorithm::Reno, "reno");
+        recover_holes(CongestionControl::Algorithm::Cubic, "cubic");
+        recover_holes(CongestionControl::Algorithm::Delay, "delay");
+
+        const vector<pair<CongestionControl::Algorithm, string>> algorithms = {
+            {CongestionControl::Algorithm::Reno, "reno"},
+            {CongestionControl::Algorithm::Cubic, "cubic"},
+            {CongestionControl::Algorithm::Delay, "delay"}};
+
+        vector<Result> shared_results;
+        for (const auto &[algorithm, name] : algorithms) {
+            const Result alone = share_bottleneck(algorithm, 1);
+            if (alone.utilization < 0.9) {
+                throw runtime_error(name + " alone used " + to_string(alone.utilization) + " of the bottleneck");
+            }
+            const Result shared = share_bottleneck(algorithm, 3);
+            if (shared.utilization < 0.9) {
+                throw runtime_error(name + " x3 used " + to_string(shared.utilization) + " of the bottleneck");
+            }
+            if (shared.fairness < 0.9) {
+                throw runtime_error(name + " x3 had a Jain fairness index of " + to_string(shared.fairness));
+            }
+            shared_results.push_back(shared);
+        }
+
+        // the delay-based model backs off before the queue overflows
+        if (shared_results.at(2).dropped >= shared_results.at(0).dropped) {
+            throw runtime_error("delay-based senders lost " + to_string(shared_results.at(2).dropped) +
+                                " segments, Reno only " + to_string(shared_results.at(0).dropped));
+        }
+
+        // without a congestion window, the senders keep the queue overflowing
+        const Result none = share_bottleneck(CongestionControl::Algorithm::None, 3);
+        if (none.dropped <= shared_results.at(0).dropped or none.utilization >= shared_results.at(0).utilization) {
+            throw runtime_error("senders without congestion control did no worse than Reno");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include "congestion_harness.hh"
+#include "sender_harness.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+struct LossyRun {
+    uint64_t delivered;
+    uint64_t fast_retransmits;
+    uint64_t timeouts;
+};
+
+// One bulk sender without SACK over a 1 MB/s, 20 ms RTT link that loses 1% of segments at random.
+static LossyRun bulk_over_lossy_link(const bool fast_retransmit) {
+    BottleneckNetwork net{1000, 64000, 10};
+    net.with_loss(0.01);
+    TCPConfig cfg;
+    cfg.rt_timeout = TCPConfig::TIMEOUT_DFLT;
+    cfg.congestion_control = CongestionControl::Algorithm::Reno;
+    cfg.fast_retransmit = fast_retransmit;
+    const size_t host = net.add_host(cfg);
+    net.run(20000);
+    return {net.delivered().at(host), net.host(host).sender().fast_retransmits(), net.host(host).sender().timeouts()};
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"Third duplicate ACK resends the hole; a partial ACK resends the next", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            for (const string chunk : {"abc", "def", "ghi", "jkl", "mno"}) {
+                test.execute(WriteBytes(string(chunk)));
+                test.execute(ExpectSegment{}.with_data(chunk));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000));
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000));
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000));
+            test.execute(ExpectSegment{}.with_data("def").with_seqno(isn + 4));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 7}}.with_win(1000));
+            test.execute(ExpectSegment{}.with_data("ghi").with_seqno(isn + 7));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 16}}.with_win(1000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectRetransmissions{2, 0});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            const size_t rto = uniform_int_distribution<uint16_t>{30, 10000}(rd);
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = rto;
+
+            TCPSenderTestHarness test{"Without fast_retransmit, duplicate ACKs wait for the timer", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(WriteBytes("abc"));
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(WriteBytes("def"));
+            test.execute(ExpectSegment{}.with_data("def"));
+            for (int i = 0; i < 5; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{rto});
+            test.execute(ExpectSegment{}.with_data("abc").with_seqno(isn + 1));
+            test.execute(ExpectRetransmissions{0, 1});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"A change in window size is not a duplicate ACK", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(WriteBytes("abc"));
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(999));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(998));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(997));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(996));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectRetransmissions{0, 0});
+        }
+
+        // With 1% loss and no SACK, each loss otherwise costs a timeout of at least one second
+        {
+            const LossyRun slow = bulk_over_lossy_link(false);
+            const LossyRun fast = bulk_over_lossy_link(true);
+            if (fast.fast_retransmits < 5 * fast.timeouts or fast.timeouts >= slow.timeouts) {
+                throw runtime_error("fast retransmit: " + to_string(fast.fast_retransmits) + " fast, " +
+                                    to_string(fast.timeouts) + " timeouts; without: " + to_string(slow.timeouts) +
+                                    " timeouts");
+            }
+            if (fast.delivered < 3 * slow.delivered) {
+                throw runtime_error("fast retransmit delivered " + to_string(fast.delivered) + " bytes, vs " +
+                                    to_string(slow.delivered) + " without");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+#include "sender_harness.hh"
+#include "tcp_connection.hh"
+#include "tcp_receiver.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// A sender with MTU probing on a path that silently drops payloads larger than `path_mss`.
+// Returns the MSS the sender settles on after `ms` milliseconds of a bulk transfer.
+static size_t probe_path(const size_t path_mss, const uint64_t ms) {
+    TCPConfig cfg;
+    cfg.mss = 8960;
+    cfg.mtu_probing = true;
+    TCPSender sender{cfg};
+    TCPReceiver receiver{cfg.recv_capacity};
+    const string data(TCPConfig::DEFAULT_CAPACITY, 'x');
+    uint64_t delivered = 0, sent = 0;
+
+    for (uint64_t now = 0; now < ms; now++) {
+        sent += sender.stream_in().write_view({data.data(), sender.stream_in().remaining_capacity()});
+        sender.fill_window();
+        while (not sender.segments_out().empty()) {
+            const TCPSegment seg = sender.segments_out().front();
+            sender.segments_out().pop();
+            if (seg.payload().size() > path_mss) {
+                continue;
+            }
+            receiver.segment_received(seg);
+            sender.ack_received(receiver.ackno().value(), receiver.window_size());
+        }
+        delivered += receiver.stream_out().buffer_size();
+        receiver.stream_out().pop_output(receiver.stream_out().buffer_size());
+        sender.tick(1);
+    }
+    if (delivered + sender.stream_in().buffer_size() + sender.bytes_in_flight() < sent - 1) {
+        throw runtime_error("probing lost data: " + to_string(delivered) + " of " + to_string(sent) + " delivered");
+    }
+    return sender.mss();
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 1460;
+
+            TCPSenderTestHarness test{"Segments are cut at the configured MSS", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes(string(4000, 'x')));
+            test.execute(ExpectSegment{}.with_payload_size(1460).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1460).with_seqno(isn + 1461));
+            test.execute(ExpectSegment{}.with_payload_size(1080).with_seqno(isn + 2921));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 8960;
+            cfg.mtu_probing = true;
+
+            TCPSenderTestHarness test{"Probes halve the distance to the MSS, and an acked probe raises it", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes(string(7000, 'x')));
+            test.execute(ExpectSegment{}.with_payload_size(4980).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000));
+            test.execute(ExpectSegment{}.with_payload_size(1000));
+            test.execute(ExpectSegment{}.with_payload_size(20));
+            test.execute(AckReceived{WrappingInt32{isn + 7001}}.with_win(20000));
+            test.execute(WriteBytes(string(16000, 'x')));
+            test.execute(ExpectSegment{}.with_payload_size(6970));
+            test.execute(ExpectSegment{}.with_payload_size(4980));
+            test.execute(ExpectSegment{}.with_payload_size(4050));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 8960;
+            cfg.mtu_probing = true;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"A lost probe is resent at the current MSS, without a congestion response",
+                                      cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes(string(8000, 'x')));
+            test.execute(ExpectSegment{}.with_payload_size(4980).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000));
+            test.execute(ExpectSegment{}.with_payload_size(1000));
+            test.execute(ExpectSegment{}.with_payload_size(1000));
+            test.execute(ExpectSegment{}.with_payload_size(20));
+            for (int i = 0; i < 3; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            }
+            for (unsigned i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(980).with_seqno(isn + 4001));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectRetransmissions{0, 0});
+            test.execute(AckReceived{WrappingInt32{isn + 8001}}.with_win(20000));
+
+            // the next probe searches below the size that failed
+            test.execute(WriteBytes(string(3000, 'x')));
+            test.execute(ExpectSegment{}.with_payload_size(2990));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 8960;
+            cfg.mtu_probing = true;
+
+            TCPSenderTestHarness test{"A probe that times out is resent at the current MSS, without backoff", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes(string(4980, 'x')));
+            test.execute(ExpectSegment{}.with_payload_size(4980).with_seqno(isn + 1));
+            test.execute(Tick{TCPConfig::TIMEOUT_DFLT});
+            for (unsigned i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(980).with_seqno(isn + 4001));
+            test.execute(Tick{TCPConfig::TIMEOUT_DFLT - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectRetransmissions{0, 1});
+        }
+
+        // the search settles just under a 1400-byte path limit, or at the MSS when nothing is in the way
+        {
+            const size_t mss = probe_path(1400, 1000);
+            if (mss > 1400 or mss + 64 < 1400) {
+                throw runtime_error("probing settled on " + to_string(mss) + " bytes for a 1400-byte path");
+            }
+            const size_t open_mss = probe_path(9000, 1000);
+            if (open_mss + 64 < 8960) {
+                throw runtime_error("probing settled on " + to_string(open_mss) + " bytes for an 8960-byte MSS");
+            }
+        }
+
+        // the MSS options on the SYNs bound both senders
+        {
+            TCPConfig big, small;
+            big.mss = 1460;
+            small.mss = 536;
+            TCPConnection client{big}, server{small};
+            client.connect();
+            const TCPSegment syn = client.segments_out().front();
+            if (syn.header().mss != 1460) {
+                throw runtime_error("SYN did not announce an MSS of 1460: " + syn.header().summary());
+            }
+            for (int i = 0; i < 3; i++) {
+                while (not client.segments_out().empty()) {
+                    server.segment_received(client.segments_out().front());
+                    client.segments_out().pop();
+                }
+                while (not server.segments_out().empty()) {
+                    client.segment_received(server.segments_out().front());
+                    server.segments_out().pop();
+                }
+            }
+            client.write(string(2000, 'x'));
+            server.write(string(2000, 'x'));
+            if (client.segments_out().empty() or client.segments_out().front().payload().size() != 536 or
+                server.segments_out().empty() or server.segments_out().front().payload().size() != 536) {
+                throw runtime_error("segments should be cut at the smaller of the two MSS options");
+            }
+        }
+
+        // an MSS option of 0 would leave nothing to send: it is raised to 536, but never above our own MSS
+        {
+            for (const size_t own_mss : {size_t{1460}, size_t{100}}) {
+                TCPConfig cfg;
+                cfg.mss = own_mss;
+                TCPSender sender{cfg};
+                sender.fill_window();
+                sender.ack_received(sender.next_seqno(), 10000);
+                sender.set_peer_mss(0);
+                sender.stream_in().write(string(2000, 'x'));
+                sender.segments_out() = {};
+                sender.fill_window();
+                const size_t expected = min(own_mss, size_t{536});
+                if (sender.segments_out().empty() or sender.segments_out().front().payload().size() != expected) {
+                    throw runtime_error("a peer MSS of 0 should give " + to_string(expected) + "-byte segments");
+                }
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
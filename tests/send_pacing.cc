@@ -0,0 +1,107 @@
+#include "congestion_harness.hh"
+#include "sender_harness.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+struct Result {
+    uint64_t dropped;
+    double utilization;
+};
+
+// A 1 MB/s bottleneck (1 segment per ms) with a 20 ms RTT and a shallow queue of 5 segments. The receive window
+// is the bandwidth-delay product plus the queue, so a sender that spaces its window over the RTT never overflows
+// the queue, while one that sends the window as a burst overflows it every round trip.
+static Result shallow_queue(const CongestionControl::Algorithm algorithm, const bool pacing) {
+    const size_t rate = 1000;
+    const uint64_t ms = 10000;
+    BottleneckNetwork net{rate, 5 * rate, 10};
+    TCPConfig config;
+    config.rt_timeout = 200;
+    config.recv_capacity = 25 * rate;
+    config.congestion_control = algorithm;
+    config.pacing = pacing;
+    net.add_host(config);
+    net.run(ms);
+    return {net.dropped(), double(net.delivered().at(0)) / double(rate * ms)};
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.pacing = true;
+            cfg.pacing_gain = 1;
+
+            TCPSenderTestHarness test{"Pacing releases one segment per tick at window / SRTT", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{10});
+            // a 10 ms RTT and a 10000-byte window: 1000 bytes per ms
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10000));
+            test.execute(WriteBytes(string(4000, 'x')));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            for (unsigned i = 1; i < 4; i++) {
+                test.execute(Tick{1});
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+                test.execute(ExpectNoSegment{});
+            }
+        }
+
+        // the event loop is told how long to wait for the next paced segment
+        {
+            TCPConfig cfg;
+            cfg.pacing = true;
+            cfg.pacing_gain = 1;
+            TCPSender sender{cfg};
+            sender.fill_window();
+            sender.tick(20);
+            sender.ack_received(sender.next_seqno(), 2000);
+            if (sender.pacing_delay().has_value()) {
+                throw runtime_error("pacing_delay() is set with nothing to send");
+            }
+            sender.stream_in().write(string(2000, 'x'));
+            sender.fill_window();
+            // 2000 bytes per 20 ms: the second segment may go 10 ms after the first
+            if (sender.pacing_delay() != 10) {
+                throw runtime_error("pacing_delay() should be 10 ms, not " +
+                                    to_string(sender.pacing_delay().value_or(0)));
+            }
+        }
+
+        // a paced sender loses fewer segments to the queue, and gets more through
+        const vector<pair<CongestionControl::Algorithm, string>> algorithms = {
+            {CongestionControl::Algorithm::None, "window-limited"}, {CongestionControl::Algorithm::Reno, "reno"}};
+        for (const auto &[algorithm, name] : algorithms) {
+            const Result burst = shallow_queue(algorithm, false);
+            const Result paced = shallow_queue(algorithm, true);
+            if (paced.dropped * 2 > burst.dropped) {
+                throw runtime_error("paced " + name + " sender lost " + to_string(paced.dropped) +
+                                    " segments to the queue, bursty sender " + to_string(burst.dropped));
+            }
+            if (paced.utilization < 0.9 or paced.utilization < burst.utilization) {
+                throw runtime_error("paced " + name + " sender used " + to_string(paced.utilization) +
+                                    " of the bottleneck, bursty sender " + to_string(burst.utilization));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+#include "sender_harness.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 10;
+
+            TCPSenderTestHarness test{"SRTT, RTTVAR and RTO follow RFC 6298", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(ExpectRtt{0, 0, TCPConfig::TIMEOUT_DFLT});
+            test.execute(Tick{50});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(ExpectRtt{50, 25, 150});
+            test.execute(WriteBytes("abc"));
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{30});
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000));
+            test.execute(ExpectRtt{47.5, 23.75, 143});
+            test.execute(WriteBytes("def"));
+            test.execute(ExpectSegment{}.with_data("def"));
+            test.execute(Tick{142});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("def").with_seqno(isn + 4));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 10;
+
+            TCPSenderTestHarness test{"Karn's algorithm: no sample from a retransmitted segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(ExpectRtt{40, 20, 120});
+            test.execute(WriteBytes("abc"));
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{120});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{5});
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000));
+            test.execute(ExpectRtt{40, 20, 120});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 200;
+            cfg.rto_max = 500;
+
+            TCPSenderTestHarness test{"The computed RTO and its backoff stay within rto_min and rto_max", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{2});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(ExpectRtt{2, 1, 200});
+            test.execute(WriteBytes("abc"));
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{200});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{400});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{499});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{500});
+            test.execute(ExpectSegment{}.with_data("abc"));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            const size_t rto = uniform_int_distribution<uint16_t>{30, 10000}(rd);
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = rto;
+
+            TCPSenderTestHarness test{"Without adaptive_rto the estimate is kept but the timer is not", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(ExpectRtt{10, 5, rto});
+            test.execute(WriteBytes("abc"));
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{rto - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("abc"));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 10;
+            cfg.timestamps = true;
+
+            TCPSenderTestHarness test{"With timestamps, the echoed TSval gives a sample even after a retransmission",
+                                      cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn).with_tsval(1));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000).with_tsecr(1));
+            test.execute(ExpectRtt{40, 20, 120});
+            test.execute(WriteBytes("abc"));
+            test.execute(ExpectSegment{}.with_data("abc").with_tsval(41));
+            test.execute(Tick{120});
+            test.execute(ExpectSegment{}.with_data("abc").with_tsval(161));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000).with_tsecr(161));
+            test.execute(ExpectRtt{40, 15, 100});
+
+            // a duplicate ACK acknowledges nothing new, so its TSecr is not a sample
+            test.execute(WriteBytes("def"));
+            test.execute(ExpectSegment{}.with_data("def").with_tsval(201));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_win(1000).with_tsecr(11));
+            test.execute(ExpectRtt{40, 15, 100});
+
+            // a TSecr ahead of our clock is not a sample, and a retransmitted segment gives no Karn sample either
+            test.execute(Tick{90});
+            test.execute(ExpectSegment{}.with_data("def").with_tsval(301));
+            test.execute(Tick{20});
+            test.execute(AckReceived{WrappingInt32{isn + 7}}.with_win(1000).with_tsecr(UINT32_MAX - 5));
+            test.execute(ExpectRtt{40, 15, 100});
+
+            // ... but a segment sent once still gives its Karn sample
+            test.execute(WriteBytes("ghi"));
+            test.execute(ExpectSegment{}.with_data("ghi").with_tsval(321));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 10}}.with_win(1000).with_tsecr(5000));
+            test.execute(ExpectRtt{40, 11.25, 85});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,238 @@
+#include "sender_harness.hh"
+#include "tcp_receiver.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+struct LossyRun {
+    uint64_t dropped_bytes;
+    uint64_t retransmitted_bytes;
+    size_t elapsed_ms;
+};
+
+// Push `len` bytes through a zero-delay link that loses the first transmission of some data segments.
+// ACKs are never lost. With `sack`, every ACK carries the receiver's SACK blocks.
+static LossyRun run_lossy_link(const bool sack, const size_t len, const WrappingInt32 isn, const uint16_t rto) {
+    const size_t capacity = 64000;
+    TCPSender sender{capacity, rto, isn};
+    TCPReceiver receiver{capacity};
+    const string data = string(len, 'x');
+    size_t written = 0, read = 0;
+    set<uint64_t> sent_once;
+    LossyRun run{0, 0, 0};
+
+    while (not receiver.stream_out().input_ended() or sender.bytes_in_flight() != 0) {
+        if (written < len) {
+            written += sender.stream_in().write(data.substr(written, sender.stream_in().remaining_capacity()));
+            if (written == len) {
+                sender.stream_in().end_input();
+            }
+        }
+        sender.fill_window();
+        if (sender.segments_out().empty()) {
+            sender.tick(1);
+            ++run.elapsed_ms;
+            if (run.elapsed_ms > 1000 * 1000) {
+                throw runtime_error("transfer over the lossy link never finished");
+            }
+            continue;
+        }
+        while (not sender.segments_out().empty()) {
+            const TCPSegment seg = sender.segments_out().front();
+            sender.segments_out().pop();
+            const uint64_t seqno = unwrap(seg.header().seqno, isn, sender.next_seqno_absolute());
+            const bool first = sent_once.insert(seqno).second;
+            // deterministic ~6% loss, keyed on the seqno so both runs lose the same bytes
+            if (first and seg.payload().size() and not seg.header().fin and (seqno * 2654435761u) % 97 < 6) {
+                run.dropped_bytes += seg.length_in_sequence_space();
+                continue;
+            }
+            receiver.segment_received(seg);
+            const auto blocks = sack ? receiver.sack_blocks(4) : vector<pair<WrappingInt32, WrappingInt32>>{};
+            const auto win = static_cast<uint16_t>(min(receiver.window_size(), size_t{UINT16_MAX}));
+            sender.ack_received(receiver.ackno().value(), win, blocks);
+        }
+        read += receiver.stream_out().read(receiver.stream_out().buffer_size()).size();
+    }
+    if (read != len) {
+        throw runtime_error("lossy link delivered " + to_string(read) + " bytes instead of " + to_string(len));
+    }
+    run.retransmitted_bytes = sender.retransmitted_bytes();
+    return run;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"SACKed bytes leave flight; a hole under 3 SACKed segments is resent", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(ExpectState{TCPSenderStateSummary::SYN_ACKED});
+            for (const string chunk : {"abc", "def", "ghi", "jkl", "mno"}) {
+                test.execute(WriteBytes(string(chunk)));
+                test.execute(ExpectSegment{}.with_data(chunk));
+            }
+            test.execute(ExpectBytesInFlight{15});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000).with_sack(isn + 4, isn + 7));
+            test.execute(ExpectBytesInFlight{12});
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000).with_sack(isn + 4, isn + 13));
+            test.execute(ExpectBytesInFlight{6});
+            test.execute(ExpectSegment{}.with_data("abc").with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000).with_sack(isn + 4, isn + 13));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 13}}.with_win(1000));
+            test.execute(ExpectBytesInFlight{3});
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            const size_t rto = uniform_int_distribution<uint16_t>{30, 10000}(rd);
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = rto;
+
+            TCPSenderTestHarness test{"Timeout resends the first hole; the ACK clock releases the rest", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            for (const string chunk : {"abc", "def", "ghi", "jkl", "mno"}) {
+                test.execute(WriteBytes(string(chunk)));
+                test.execute(ExpectSegment{}.with_data(chunk));
+            }
+            test.execute(
+                AckReceived{WrappingInt32{isn + 1}}.with_win(1000).with_sack(isn + 4, isn + 7).with_sack(isn + 10,
+                                                                                                      isn + 13));
+            test.execute(ExpectBytesInFlight{9});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{rto});
+            test.execute(ExpectSegment{}.with_data("abc").with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            test.execute(
+                AckReceived{WrappingInt32{isn + 4}}.with_win(1000).with_sack(isn + 10, isn + 13));
+            test.execute(ExpectSegment{}.with_data("ghi").with_seqno(isn + 7));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 13}}.with_win(1000));
+            test.execute(ExpectBytesInFlight{3});
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"A segment carrying FIN is never counted as SACKed", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000));
+            test.execute(WriteBytes("abc"));
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(WriteBytes("def").with_end_input(true));
+            test.execute(ExpectSegment{}.with_data("def").with_fin(true));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(1000).with_sack(isn + 4, isn + 8));
+            test.execute(ExpectBytesInFlight{7});
+            test.execute(ExpectState{TCPSenderStateSummary::FIN_SENT});
+        }
+
+        // A SACK that reveals six holes at once lets the congestion window, not the number of holes,
+        // decide how many are resent; the rest follow as ACKs free up room (RFC 6675 NextSeg)
+        {
+            TCPConfig cfg;
+            cfg.congestion_control = CongestionControl::Algorithm::Reno;
+            cfg.mss = 100;
+            TCPSender sender{cfg};
+            sender.fill_window();
+            sender.segments_out().pop();
+            sender.ack_received(sender.next_seqno(), 60000);
+            sender.stream_in().write(string(10000, 'x'));
+            sender.fill_window();
+            // slow start, one ACK per segment, until 16 segments fit in the window
+            while (sender.cwnd() < 1600) {
+                const TCPSegment seg = sender.segments_out().front();
+                sender.segments_out().pop();
+                sender.ack_received(seg.header().seqno + seg.length_in_sequence_space(), 60000);
+            }
+            vector<WrappingInt32> flight;
+            for (; not sender.segments_out().empty(); sender.segments_out().pop()) {
+                flight.push_back(sender.segments_out().front().header().seqno);
+            }
+            if (flight.size() < 16) {
+                throw runtime_error("slow start left only " + to_string(flight.size()) + " segments in flight");
+            }
+
+            // segments 0-5 are lost, 6-8 arrive, the rest are still on their way
+            const vector<pair<WrappingInt32, WrappingInt32>> sack{{flight[6], flight[9]}};
+            sender.ack_received(flight[0], 60000, sack);
+            vector<WrappingInt32> resent;
+            for (; not sender.segments_out().empty(); sender.segments_out().pop()) {
+                resent.push_back(sender.segments_out().front().header().seqno);
+            }
+            if (resent.empty() or resent.size() >= 6) {
+                throw runtime_error("cwnd " + to_string(sender.cwnd()) + " let " + to_string(resent.size()) +
+                                    " of 6 holes be resent at once");
+            }
+            for (size_t i = 0; i < resent.size(); i++) {
+                if (resent[i] != flight[i]) {
+                    throw runtime_error("holes should be resent lowest first");
+                }
+            }
+
+            // the first hole's retransmission is acked: that frees room for the next hole
+            sender.ack_received(flight[1], 60000, sack);
+            if (sender.segments_out().empty() or
+                sender.segments_out().front().header().seqno != flight[resent.size()]) {
+                throw runtime_error("an ACK that frees room should release the next hole");
+            }
+        }
+
+        // Over the same lossy link, the SACK sender repairs several holes per round trip instead of one per RTO,
+        // and never resends a byte the receiver already holds.
+        {
+            const WrappingInt32 isn(rd());
+            const size_t len = 256 * 1024;
+            const LossyRun plain = run_lossy_link(false, len, isn, 100);
+            const LossyRun sacked = run_lossy_link(true, len, isn, 100);
+
+            if (sacked.dropped_bytes == 0 or sacked.dropped_bytes != plain.dropped_bytes) {
+                throw runtime_error("the lossy link did not drop the same bytes in both runs");
+            }
+            if (sacked.retransmitted_bytes != sacked.dropped_bytes) {
+                throw runtime_error("SACK sender retransmitted " + to_string(sacked.retransmitted_bytes) +
+                                    " bytes, but only " + to_string(sacked.dropped_bytes) + " were lost");
+            }
+            if (sacked.retransmitted_bytes > plain.retransmitted_bytes) {
+                throw runtime_error("SACK sender retransmitted more bytes than the plain sender");
+            }
+            if (sacked.elapsed_ms * 4 > plain.elapsed_ms) {
+                throw runtime_error("SACK recovery took " + to_string(sacked.elapsed_ms) + " ms vs " +
+                                    to_string(plain.elapsed_ms) + " ms without SACK");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
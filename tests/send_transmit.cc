@@ -1,4 +1,6 @@
+#include "byte_stream.hh"
 #include "sender_harness.hh"
+#include "util.hh"
 #include "wrapping_integers.hh"
 
 #include <cstdint>
@@ -147,6 +149,96 @@ int main() {
             test.execute(ExpectSeqno{WrappingInt32{isn + 1 + 3}});
         }
 
+        // segments cut from one write are slices of the same chunk of the send buffer, not copies
+        {
+            TCPSender sender{TCPConfig{}};
+            sender.fill_window();
+            sender.ack_received(sender.next_seqno(), 5000);
+            sender.segments_out().pop();
+            sender.stream_in().write(string(2500, 'x'));
+            sender.fill_window();
+            if (sender.segments_out().size() != 3) {
+                throw runtime_error("2500 bytes should go out in 3 segments");
+            }
+            const char *first = sender.segments_out().front().payload().str().data();
+            sender.segments_out().pop();
+            const char *second = sender.segments_out().front().payload().str().data();
+            if (second != first + TCPConfig::MAX_PAYLOAD_SIZE) {
+                throw runtime_error("the sender copied a payload out of its send buffer");
+            }
+        }
+
+        // short writes are appended to one chunk, past the payloads already cut from it
+        {
+            TCPSender sender{TCPConfig{}};
+            sender.fill_window();
+            sender.ack_received(sender.next_seqno(), 5000);
+            sender.segments_out().pop();
+            sender.stream_in().write("abc");
+            sender.fill_window();
+            sender.stream_in().write("defg");
+            sender.fill_window();
+            if (sender.segments_out().size() != 2) {
+                throw runtime_error("two short writes should go out in 2 segments");
+            }
+            const Buffer first = sender.segments_out().front().payload();
+            sender.segments_out().pop();
+            const Buffer second = sender.segments_out().front().payload();
+            if (first.str() != "abc" or second.str() != "defg") {
+                throw runtime_error("appending a short write changed a payload already sent");
+            }
+            if (second.str().data() != first.str().data() + first.size()) {
+                throw runtime_error("short writes should share one chunk of the send buffer");
+            }
+
+            ByteStream original{100, ByteStream::Storage::Chunks};
+            original.write("abc");
+            ByteStream copy{original};
+            original.write("def");
+            copy.write("xyz");
+            if (original.read(6) != "abcdef" or copy.read(6) != "abcxyz") {
+                throw runtime_error("a copy of a ByteStream should not append to the original's chunk");
+            }
+
+            // a chunk whose front was popped, or a slice written back in, is not grown in place
+            ByteStream popped{100, ByteStream::Storage::Chunks};
+            popped.write("abc");
+            popped.pop_output(1);
+            popped.write("def");
+            const Buffer slice = popped.read_buffer(2);
+            popped.write(slice);
+            popped.write("gh");
+            if (popped.read(8) != "defbcgh") {
+                throw runtime_error("short writes after a partial pop should keep every byte in order");
+            }
+        }
+
+        // the payload is summed once, when it is cut; a retransmission reuses the sum
+        {
+            TCPSender sender{TCPConfig{}};
+            sender.fill_window();
+            sender.ack_received(sender.next_seqno(), 5000);
+            sender.segments_out().pop();
+            sender.stream_in().write(string(500, 'x'));
+            sender.fill_window();
+            const TCPSegment first = sender.segments_out().front();
+            sender.segments_out().pop();
+            sender.tick(TCPConfig::TIMEOUT_DFLT);
+            if (sender.segments_out().empty()) {
+                throw runtime_error("the segment was not retransmitted");
+            }
+            const TCPSegment retx = sender.segments_out().front();
+            InternetChecksum check;
+            check.add(first.payload());
+            if (first.payload().partial_checksum() != check.sum() or
+                retx.payload().partial_checksum() != check.sum()) {
+                throw runtime_error("segments should carry their payload's sum for TCPSegment::serialize()");
+            }
+            if (retx.serialize().concatenate() != first.serialize().concatenate()) {
+                throw runtime_error("the retransmission should serialize to the same bytes as the original");
+            }
+        }
+
     } catch (const exception &e) {
         cerr << e.what() << endl;
         return 1;
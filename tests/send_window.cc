@@ -132,6 +132,52 @@ int main() {
             test.execute(ExpectSegment{}.with_fin(true).with_data("4567"));
             test.execute(ExpectNoSegment{});
         }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"A zero-window probe refused for lack of room is resent when the window opens",
+                                      cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{20});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_no_flags().with_data("a"));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(ExpectNoSegment{});
+            // a round trip after the probe was sent, it has not been acked: the receiver dropped it
+            test.execute(Tick{20});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10));
+            test.execute(ExpectSegment{}.with_no_flags().with_data("a"));
+            test.execute(ExpectSegment{}.with_no_flags().with_data("bcd"));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{cfg.rt_timeout - 1u});
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"A zero-window probe still in flight when the window opens is not resent", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{20});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(0));
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_no_flags().with_data("a"));
+            // the window update was sent before the probe arrived
+            test.execute(Tick{5});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(10));
+            test.execute(ExpectSegment{}.with_no_flags().with_data("bcd"));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 5}}.with_win(10));
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectNoSegment{});
+        }
     } catch (const exception &e) {
         cerr << e.what() << endl;
         return 1;
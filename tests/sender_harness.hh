@@ -15,6 +15,8 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
@@ -99,6 +101,50 @@ struct ExpectBytesInFlight : public SenderExpectation {
     }
 };
 
+struct ExpectRetransmissions : public SenderExpectation {
+    uint64_t _fast_retransmits;
+    uint64_t _timeouts;
+
+    ExpectRetransmissions(uint64_t fast_retransmits, uint64_t timeouts)
+        : _fast_retransmits(fast_retransmits), _timeouts(timeouts) {}
+    std::string description() const {
+        return std::to_string(_fast_retransmits) + " fast retransmits and " + std::to_string(_timeouts) +
+               " timeouts";
+    }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.fast_retransmits() != _fast_retransmits or sender.timeouts() != _timeouts) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported " << sender.fast_retransmits() << " fast retransmits and "
+               << sender.timeouts() << " timeouts, but there were expected to be " << _fast_retransmits << " and "
+               << _timeouts;
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+struct ExpectRtt : public SenderExpectation {
+    double _srtt;
+    double _rttvar;
+    size_t _rto;
+
+    ExpectRtt(double srtt, double rttvar, size_t rto) : _srtt(srtt), _rttvar(rttvar), _rto(rto) {}
+    std::string description() const {
+        std::ostringstream ss;
+        ss << "srtt " << _srtt << " ms, rttvar " << _rttvar << " ms, rto " << _rto << " ms";
+        return ss.str();
+    }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.srtt() != _srtt or sender.rttvar() != _rttvar or sender.rto() != _rto) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported srtt " << sender.srtt() << ", rttvar " << sender.rttvar() << ", rto "
+               << sender.rto() << ", but they were expected to be " << _srtt << ", " << _rttvar << ", " << _rto;
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
 struct ExpectNoSegment : public SenderExpectation {
     ExpectNoSegment() {}
     std::string description() const { return "no (more) segments"; }
@@ -191,11 +237,19 @@ struct Tick : public SenderAction {
 struct AckReceived : public SenderAction {
     WrappingInt32 _ackno;
     std::optional<uint16_t> _window_advertisement{};
+    std::vector<std::pair<WrappingInt32, WrappingInt32>> _sack{};
+    std::optional<uint32_t> _ts_ecr{};
 
     AckReceived(WrappingInt32 ackno) : _ackno(ackno) {}
     std::string description() const {
         std::ostringstream ss;
         ss << "ack " << _ackno.raw_value() << " winsize " << _window_advertisement.value_or(DEFAULT_TEST_WINDOW);
+        for (const auto &[left, right] : _sack) {
+            ss << " sack " << left.raw_value() << "-" << right.raw_value();
+        }
+        if (_ts_ecr.has_value()) {
+            ss << " tsecr " << _ts_ecr.value();
+        }
         return ss.str();
     }
 
@@ -204,12 +258,28 @@ struct AckReceived : public SenderAction {
         return *this;
     }
 
+    AckReceived &with_sack(WrappingInt32 left, WrappingInt32 right) {
+        _sack.emplace_back(left, right);
+        return *this;
+    }
+
+    AckReceived &with_tsecr(uint32_t ts_ecr) {
+        _ts_ecr.emplace(ts_ecr);
+        return *this;
+    }
+
     void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
-        sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW));
+        sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW), _sack, true, _ts_ecr);
         sender.fill_window();
     }
 };
 
+struct Flush : public SenderAction {
+    std::string description() const { return "flush"; }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const { sender.flush(); }
+};
+
 struct Close : public SenderAction {
     Close() {}
     std::string description() const { return "close"; }
@@ -230,6 +300,7 @@ struct ExpectSegment : public SenderExpectation {
     std::optional<uint16_t> win{};
     std::optional<size_t> payload_size{};
     std::optional<std::string> data{};
+    std::optional<uint32_t> tsval{};
 
     ExpectSegment &with_ack(bool ack_) {
         ack = ack_;
@@ -288,6 +359,11 @@ struct ExpectSegment : public SenderExpectation {
         return *this;
     }
 
+    ExpectSegment &with_tsval(uint32_t tsval_) {
+        tsval = tsval_;
+        return *this;
+    }
+
     std::string segment_description() const {
         std::ostringstream o;
         o << "(";
@@ -315,6 +391,9 @@ struct ExpectSegment : public SenderExpectation {
         if (payload_size.has_value()) {
             o << "payload_size=" << payload_size.value() << ",";
         }
+        if (tsval.has_value()) {
+            o << "tsval=" << tsval.value() << ",";
+        }
         if (data.has_value()) {
             o << "\"";
             for (unsigned int i = 0; i < std::min(size_t(16), data.value().size()); i++) {
@@ -336,7 +415,7 @@ struct ExpectSegment : public SenderExpectation {
 
     virtual std::string description() const { return "segment sent with " + segment_description(); }
 
-    void execute(TCPSender &, std::queue<TCPSegment> &segments) const {
+    void execute(TCPSender &sender, std::queue<TCPSegment> &segments) const {
         if (segments.empty()) {
             throw SegmentExpectationViolation::violated_verb("existed");
         }
@@ -363,11 +442,18 @@ struct ExpectSegment : public SenderExpectation {
         if (win.has_value() and seg.header().win != win.value()) {
             throw SegmentExpectationViolation::violated_field("win", win.value(), seg.header().win);
         }
+        if (tsval.has_value() and not seg.header().timestamps.has_value()) {
+            throw SegmentExpectationViolation("packet has no timestamps, but TSval " + std::to_string(tsval.value()) +
+                                              " was expected");
+        }
+        if (tsval.has_value() and seg.header().timestamps->first != tsval.value()) {
+            throw SegmentExpectationViolation::violated_field("tsval", tsval.value(), seg.header().timestamps->first);
+        }
         if (payload_size.has_value() and seg.payload().size() != payload_size.value()) {
             throw SegmentExpectationViolation::violated_field(
                 "payload_size", payload_size.value(), seg.payload().size());
         }
-        if (seg.payload().size() > TCPConfig::MAX_PAYLOAD_SIZE) {
+        if (seg.payload().size() > sender.mss_limit()) {
             throw SegmentExpectationViolation("packet has length (" + std::to_string(seg.payload().size()) +
                                               ") greater than the maximum");
         }
@@ -394,7 +480,7 @@ class TCPSenderTestHarness {
   public:
     TCPSenderTestHarness(const std::string &name_, TCPConfig config)
         : outbound_segments()
-        , sender(config.send_capacity, config.rt_timeout, config.fixed_isn)
+        , sender(config)
         , steps_executed()
         , name(name_) {
         sender.fill_window();
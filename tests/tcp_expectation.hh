@@ -564,4 +564,9 @@ struct Close : public TCPAction {
     void execute(TCPTestHarness &harness) const { harness._fsm.end_input_stream(); }
 };
 
+struct UpdateWindow : public TCPAction {
+    std::string description() const { return "update window"; }
+    void execute(TCPTestHarness &harness) const { harness._fsm.update_window(); }
+};
+
 #endif  // SPONGE_LIBSPONGE_TCP_EXPECTATION_HH
@@ -37,6 +37,7 @@ struct Tick;
 struct Connect;
 struct Listen;
 struct Close;
+struct UpdateWindow;
 
 class TCPExpectationViolation : public std::runtime_error {
   public: